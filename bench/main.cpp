@@ -0,0 +1,261 @@
+#include "Common.h"
+#include "Engine/Camera.h"
+#include "Engine/Chunk.h"
+#include "Engine/ChunkMesher.h"
+#include "Engine/InfiniteWorld.h"
+#include "Generation/ColumnCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <thread>
+
+// Headless benchmarks for the engine, no window or GL context. Everything runs
+// from a fixed seed so numbers are comparable between builds.
+//   VoxelBench [--seed N] [--chunks N] [--sweep N] [--edits N]
+unsigned int GLOBAL_SEED = 1337;
+
+// Every heap allocation in the process goes through here, each benchmark
+// reports how many it made
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+
+struct BenchOptions {
+    int gridSize = 16;   // generation/meshing run on gridSize^2 chunks
+    int sweepChunks = 32; // chunks the camera travels in the world sweep
+    int edits = 20000;
+};
+
+struct BenchTimer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    size_t startAllocations = allocationCount.load();
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    size_t allocations() const { return allocationCount.load() - startAllocations; }
+};
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[size_t(p * (values.size() - 1))];
+}
+
+// Terrain and light for a grid of standalone chunks, starting from a cold column cache
+static std::vector<std::unique_ptr<Chunk>> benchGeneration(const BenchOptions& options) {
+    std::vector<std::unique_ptr<Chunk>> grid;
+    for (int z = 0; z < options.gridSize; z++) {
+        for (int x = 0; x < options.gridSize; x++) {
+            grid.push_back(std::make_unique<Chunk>(ChunkCoord(x, z)));
+        }
+    }
+    ColumnCache::get().clear();
+
+    BenchTimer timer;
+    for (auto& chunk : grid) {
+        chunk->generateTerrain();
+        chunk->computeLight();
+    }
+    double seconds = timer.seconds();
+    size_t allocations = timer.allocations();
+
+    size_t bytes = 0;
+    for (auto& chunk : grid) bytes += chunk->getMemoryUsage();
+    double count = double(grid.size());
+    printf("generation  %6zu chunks  %10.1f chunks/s  %8.1f bytes/chunk  %6.2f allocs/chunk\n",
+           grid.size(), count / seconds, bytes / count, allocations / count);
+    return grid;
+}
+
+// Snapshots and greedy-meshes every non-empty section of the grid at each level of detail
+static void benchMeshing(const BenchOptions& options, std::vector<std::unique_ptr<Chunk>>& grid) {
+    int size = options.gridSize;
+    for (int z = 0; z < size; z++) {
+        for (int x = 0; x < size; x++) {
+            Chunk* chunk = grid[z * size + x].get();
+            chunk->neighbours[NEIGHBOUR_NEG_X] = x > 0 ? grid[z * size + x - 1].get() : nullptr;
+            chunk->neighbours[NEIGHBOUR_POS_X] = x + 1 < size ? grid[z * size + x + 1].get() : nullptr;
+            chunk->neighbours[NEIGHBOUR_NEG_Z] = z > 0 ? grid[(z - 1) * size + x].get() : nullptr;
+            chunk->neighbours[NEIGHBOUR_POS_Z] = z + 1 < size ? grid[(z + 1) * size + x].get() : nullptr;
+        }
+    }
+
+    std::unique_ptr<SectionSnapshot> snapshot = std::make_unique<SectionSnapshot>();
+    std::vector<ChunkVertex> vertices;
+    std::vector<ChunkVertex> translucentVertices;
+    vertices.reserve(MAX_QUADS_PER_SECTION * VERTICES_PER_QUAD);
+
+    for (int lod = 0; lod < LOD_LEVELS; lod++) {
+        double snapshotSeconds = 0.0;
+        double meshSeconds = 0.0;
+        size_t sections = 0;
+        size_t vertexCount = 0;
+        size_t startAllocations = allocationCount.load();
+
+        for (auto& chunk : grid) {
+            chunk->lod = lod;
+            for (int s = 0; s < SECTIONS_PER_CHUNK; s++) {
+                if (chunk->sections[s].isEmpty()) continue;
+
+                BenchTimer snapshotTimer;
+                chunk->takeSnapshot(s, *snapshot);
+                snapshotSeconds += snapshotTimer.seconds();
+
+                BenchTimer meshTimer;
+                downsampleSnapshot(*snapshot);
+                ChunkMesher mesher(*snapshot, vertices, translucentVertices);
+                mesher.generateMesh();
+                meshSeconds += meshTimer.seconds();
+
+                sections++;
+                vertexCount += vertices.size() + translucentVertices.size();
+            }
+            chunk->lod = 0;
+        }
+
+        size_t allocations = allocationCount.load() - startAllocations;
+        printf("meshing x%d  %6zu sections %10.1f sections/s %10.0f vertices/s  %6.1f vertices/section  "
+               "%6.2f us/snapshot  %zu allocs\n",
+               1 << lod, sections, sections / meshSeconds, vertexCount / meshSeconds,
+               sections ? double(vertexCount) / sections : 0.0, 1e6 * snapshotSeconds / std::max<size_t>(sections, 1),
+               allocations);
+    }
+}
+
+// One frame of the game loop without the GL parts
+static void worldFrame(InfiniteWorld& world, Camera& camera) {
+    world.update(camera);
+    mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    world.render(projection * camera.getViewMatrix(), camera.position);
+}
+
+static bool worldIdle(InfiniteWorld& world) {
+    return world.getRequestedChunkCount() == 0 && world.getPendingChunkCount() == 0 && world.getPendingMeshCount() == 0;
+}
+
+// Runs frames until every chunk around the camera is loaded and meshed
+static int drainWorld(InfiniteWorld& world, Camera& camera, std::vector<double>& frameTimes) {
+    int frames = 0;
+    do {
+        auto start = std::chrono::steady_clock::now();
+        worldFrame(world, camera);
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        frames++;
+        // Give the workers the rest of a frame like the real loop would
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } while (!worldIdle(world));
+    return frames;
+}
+
+// Streams the world in around the origin, then walks the camera along +X one
+// chunk at a time so every step loads a new row and unloads the one behind
+static void benchWorld(const BenchOptions& options) {
+    InfiniteWorld world;
+    world.renderer.setHeadless(true);
+    world.persistChunks = false;
+    Camera camera(vec3(0.5f, 48.0f, 0.5f));
+
+    std::vector<double> frameTimes;
+    BenchTimer startupTimer;
+    world.loadChunksAroundPlayer(camera.getCurrentChunkCoord());
+    drainWorld(world, camera, frameTimes);
+    double startupSeconds = startupTimer.seconds();
+    int startupChunks = world.getLoadedChunkCount();
+
+    frameTimes.clear();
+    BenchTimer sweepTimer;
+    int frames = 0;
+    for (int step = 1; step <= options.sweepChunks; step++) {
+        camera.position.x = step * CHUNK_SIZE + 0.5f;
+        frames += drainWorld(world, camera, frameTimes);
+    }
+    double sweepSeconds = sweepTimer.seconds();
+    size_t sweepAllocations = sweepTimer.allocations();
+    int sweepChunks = options.sweepChunks * (2 * RENDER_DISTANCE + 1);
+
+    std::mt19937 random(GLOBAL_SEED);
+    std::uniform_int_distribution<int> horizontal(-2 * CHUNK_SIZE, 2 * CHUNK_SIZE);
+    std::uniform_int_distribution<int> vertical(1, CHUNK_HEIGHT - 1);
+    int centerX = int(camera.position.x);
+    BenchTimer editTimer;
+    for (int i = 0; i < options.edits; i++) {
+        world.setVoxel(centerX + horizontal(random), vertical(random), horizontal(random), (i & 1) ? STONE : AIR);
+    }
+    double editSeconds = editTimer.seconds();
+    std::vector<double> remeshFrames;
+    BenchTimer remeshTimer;
+    drainWorld(world, camera, remeshFrames);
+    double remeshSeconds = remeshTimer.seconds();
+    size_t editAllocations = editTimer.allocations();
+
+    // Explosions through one reused VoxelEditBatch
+    const int explosions = 100;
+    const float explosionRadius = 5.0f;
+    std::uniform_real_distribution<float> offset(-2.0f * CHUNK_SIZE, 2.0f * CHUNK_SIZE);
+    VoxelEditBatch batch;
+    int explodedVoxels = 0;
+    BenchTimer explosionTimer;
+    for (int i = 0; i < explosions; i++) {
+        batch.clear();
+        batch.fillSphere(vec3(centerX + offset(random), 20.0f + offset(random) * 0.25f, offset(random)), explosionRadius, AIR);
+        explodedVoxels += world.applyEdits(batch);
+    }
+    double explosionSeconds = explosionTimer.seconds();
+    BenchTimer explosionRemeshTimer;
+    drainWorld(world, camera, remeshFrames);
+    double explosionRemeshSeconds = explosionRemeshTimer.seconds();
+
+    printf("startup     %6d chunks  %10.1f chunks/s (generated and meshed)\n",
+           startupChunks, startupChunks / startupSeconds);
+    printf("sweep       %6d chunks  %10.1f chunks/s  %d frames  update+render p50 %.2f ms  p99 %.2f ms  "
+           "%.1f allocs/frame\n",
+           sweepChunks, sweepChunks / sweepSeconds, frames, percentile(frameTimes, 0.5),
+           percentile(frameTimes, 0.99), double(sweepAllocations) / std::max(frames, 1));
+    printf("edits       %6d edits   %10.0f edits/s  remeshed in %.1f ms  %zu allocs\n",
+           options.edits, options.edits / editSeconds, remeshSeconds * 1000.0, editAllocations);
+    printf("explosions  %6d spheres %10.0f voxels/s  %d voxels changed  remeshed in %.1f ms\n",
+           explosions, explodedVoxels / explosionSeconds, explodedVoxels, explosionRemeshSeconds * 1000.0);
+    printf("memory      %.1f MiB voxels  %.1f MiB meshes for %d chunks\n",
+           world.getVoxelMemoryUsage() / (1024.0 * 1024.0),
+           world.renderer.getArena().getUsed() * sizeof(ChunkVertex) / (1024.0 * 1024.0), world.getLoadedChunkCount());
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--seed")) GLOBAL_SEED = unsigned(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (!strcmp(argv[i], "--chunks")) options.gridSize = std::max(1, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "--sweep")) options.sweepChunks = std::max(0, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "--edits")) options.edits = std::max(0, atoi(argv[i + 1]));
+        else {
+            std::cerr << "Unknown option " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    if (argc % 2 == 0) {
+        std::cerr << "Missing value for " << argv[argc - 1] << "\n";
+        return 1;
+    }
+
+    printf("seed %u, %d threads\n", GLOBAL_SEED, int(std::thread::hardware_concurrency()));
+    std::vector<std::unique_ptr<Chunk>> grid = benchGeneration(options);
+    benchMeshing(options, grid);
+    grid.clear();
+    benchWorld(options);
+    return 0;
+}
@@ -12,6 +12,7 @@
 #include <ctime>
 #include <string>
 #include <algorithm>
+#include <cstdint>
 
 using namespace glm;
 
@@ -21,10 +22,41 @@ extern unsigned int GLOBAL_SEED;
 constexpr int CHUNK_SIZE = 16;
 constexpr int CHUNK_HEIGHT = 64;
 constexpr int RENDER_DISTANCE = 16;
+// Chunks are split vertically into cubic sections for meshing and culling
+constexpr int SECTION_SIZE = 16;
+constexpr int SECTIONS_PER_CHUNK = CHUNK_HEIGHT / SECTION_SIZE;
+constexpr int SECTION_VOLUME = CHUNK_SIZE * SECTION_SIZE * CHUNK_SIZE;
+static_assert(CHUNK_HEIGHT % SECTION_SIZE == 0, "CHUNK_HEIGHT must be a multiple of SECTION_SIZE");
+// Per-frame GPU upload budget for finished chunk meshes
+constexpr int MAX_MESH_UPLOADS_PER_FRAME = 16;
+constexpr size_t MAX_MESH_UPLOAD_BYTES_PER_FRAME = 4 * 1024 * 1024;
+// Chunk streaming: generation jobs in flight at once (keeps the priority order
+// meaningful), main thread time per frame for adopting and dispatching chunks,
+// and the ring the loading screen waits for before the game starts
+constexpr int MAX_PENDING_CHUNK_LOADS = 32;
+constexpr double CHUNK_STREAMING_BUDGET_MS = 2.0;
+constexpr int STARTUP_LOAD_RADIUS = 3;
+// Columns of biomes with water flood up to here
+constexpr int SEA_LEVEL = 15;
+// Loaded chunks are grouped into CULL_REGION_CHUNKS^2 regions for culling
+constexpr int CULL_REGION_CHUNKS = 8;
+// Distant chunks are meshed from voxels downsampled 2^lod times. Level n starts
+// LOD_BASE_DISTANCE * 2^(n-1) blocks out, a chunk only moves to a coarser level
+// once it is LOD_HYSTERESIS blocks past the edge so rings don't flicker
+constexpr int LOD_LEVELS = 4;
+constexpr float LOD_BASE_DISTANCE = 3.0f * CHUNK_SIZE;
+constexpr float LOD_HYSTERESIS = 4.0f;
+// Translucent quads are re-sorted when the camera enters a new voxel, but only
+// in sections this close (in blocks), further out the order barely changes
+constexpr float TRANSLUCENT_SORT_DISTANCE = 2.0f * CHUNK_SIZE;
+// Spare objects kept for reuse once chunks unload, see ObjectPool
+constexpr size_t MAX_POOLED_CHUNKS = 256;
+constexpr size_t MAX_POOLED_SNAPSHOTS = 64;
+constexpr size_t MAX_POOLED_VERTEX_BUFFERS = 64;
 const float VOXEL_SIZE = 1.0f;
 
-// Voxel types
-enum VoxelType {
+// Voxel types, a voxel is stored as just this one byte (AIR means empty)
+enum VoxelType : uint8_t {
     AIR = 0,
     STONE = 1,
     GRASS = 2,
@@ -33,16 +65,52 @@ enum VoxelType {
     WATER = 5,
     SNOW = 6,
     LOG = 7,
-    LEAVES = 8
+    LEAVES = 8,
+    LAMP = 9 // emits block light, see getVoxelEmission
 };
+constexpr int VOXEL_TYPE_COUNT = 10;
+
+// Block properties compiled from the registry (see Engine/Registry.h) into
+// flat tables indexed by the voxel byte, so hot loops test a type with one
+// load instead of a switch
+enum BlockFlags : uint8_t {
+    BLOCK_SOLID = 1,       // produces faces and collides
+    BLOCK_TRANSLUCENT = 2, // drawn blended in the translucent pass (see ChunkMesher)
+    BLOCK_OPAQUE = 4       // stops light (see Lighting.h)
+};
+
+struct BlockTable {
+    uint8_t flags[256];
+    uint8_t emission[256];
+    vec3 color[256];
+};
+
+extern BlockTable BLOCK_TABLE;
+
+// Voxels that produce faces, water and air are see-through
+inline bool isSolidVoxel(VoxelType type) {
+    return BLOCK_TABLE.flags[type] & BLOCK_SOLID;
+}
+
+// Leaves stay solid for collisions and light, they just don't hide the faces behind them
+inline bool isTranslucentVoxel(VoxelType type) {
+    return BLOCK_TABLE.flags[type] & BLOCK_TRANSLUCENT;
+}
+
+// Solid voxels that hide whatever face is behind them
+inline bool occludesFaces(VoxelType type) {
+    return (BLOCK_TABLE.flags[type] & (BLOCK_SOLID | BLOCK_TRANSLUCENT)) == BLOCK_SOLID;
+}
 
 struct Biome {
-    std::string name;
+    std::string name; // only shown in the debug UI
     VoxelType surface;
     VoxelType subsurface;
     VoxelType filler;
     float baseHeight;
     float heightVariation;
+    bool trees; // grows trees where the column cache says so
+    bool water; // low ground below sea level floods
 };
 
 // Chunk coordinate structure
@@ -59,22 +127,30 @@ struct ChunkCoord {
     }
 };
 
-// Hash function for ChunkCoord
+// Hash function for ChunkCoord, mixes both axes so neighbouring chunks
+// spread out over an open-addressing table instead of clustering
 struct ChunkCoordHash {
     std::size_t operator()(const ChunkCoord& coord) const {
-        return std::hash<int>()(coord.x) ^ (std::hash<int>()(coord.z) << 1);
+        uint64_t h = uint64_t(uint32_t(coord.x)) * 0x9E3779B97F4A7C15ull;
+        h ^= uint64_t(uint32_t(coord.z)) + 0x7F4A7C159E3779B9ull + (h << 6) + (h >> 2);
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+        return std::size_t(h);
     }
 };
 
+// Floor division (and modulo by CHUNK_SIZE), correct for negative coordinates
+inline int floorDiv(int v, int divisor) {
+    return v >= 0 ? v / divisor : (v + 1) / divisor - 1;
+}
+inline int worldToChunk(int v) {
+    return floorDiv(v, CHUNK_SIZE);
+}
+inline int worldToLocal(int v) {
+    return v - worldToChunk(v) * CHUNK_SIZE;
+}
+
 // Forward declarations
 class Chunk;
 class InfiniteWorld;
-
-// Voxel structure
-struct Voxel {
-    VoxelType type;
-    bool isActive;
-    
-    Voxel() : type(AIR), isActive(false) {}
-    Voxel(VoxelType t) : type(t), isActive(t != AIR) {}
-};
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Free-list allocator over a range of elements. Only does the bookkeeping,
+// the GL buffer it describes is owned by ChunkRenderer. Free blocks sit in
+// one list sorted by offset (for merging on free) and in power of two size
+// bins (for finding a fit), both plain vectors whose capacity is kept, so
+// allocating and freeing don't touch the heap once they are warmed up.
+class BufferArena {
+public:
+    explicit BufferArena(uint32_t capacity = 0);
+
+    // Lowest offset block out of the smallest bins that can hold `size`
+    bool allocate(uint32_t size, uint32_t& offset);
+    void free(uint32_t offset, uint32_t size);
+    // Appends the extra space as one free block at the end
+    void grow(uint32_t newCapacity);
+
+    uint32_t getCapacity() const { return capacity; }
+    uint32_t getUsed() const { return used; }
+    uint32_t getLargestFreeBlock() const;
+
+private:
+    struct Block {
+        uint32_t offset;
+        uint32_t size;
+    };
+    // Bin b holds the blocks of size [2^b, 2^(b+1))
+    static constexpr int BIN_COUNT = 32;
+    static int binOf(uint32_t size);
+    static bool offsetLess(const Block& block, uint32_t offset) { return block.offset < offset; }
+
+    void addBlock(Block block);
+    void removeBlock(Block block);
+
+    std::vector<Block> freeBlocks; // sorted by offset, neighbours are merged on free()
+    std::vector<Block> bins[BIN_COUNT]; // each sorted by offset
+    uint32_t capacity;
+    uint32_t used;
+};
@@ -18,6 +18,7 @@ public:
     mat4 getViewMatrix();
     void processKeyboard(int direction, float deltaTime);
     void processMouseMovement(float xoffset, float yoffset);
+    void setOrientation(float newYaw, float newPitch);
     ChunkCoord getCurrentChunkCoord() const;
     
 private:
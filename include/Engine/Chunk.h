@@ -1,28 +1,124 @@
 #pragma once
 #include "Common.h"
+#include "Engine/ChunkMesher.h"
+#include "Engine/ChunkRenderer.h"
+#include "Engine/Lighting.h"
+#include "Engine/VoxelStorage.h"
 
 class InfiniteWorld; // Forward declaration
 
+// One SECTION_SIZE^3 slice of a chunk's column. Each section has its own mesh
+// and bounds, so edits remesh 16 layers instead of the whole column and
+// empty sky sections cost nothing.
+struct ChunkSection {
+    VoxelStorage voxels;
+    LightStorage light;
+    MeshAllocation mesh;
+    // Water and leaves, drawn after everything opaque (see isTranslucentVoxel).
+    // The CPU copy is re-sorted back to front as the camera moves.
+    MeshAllocation translucentMesh;
+    std::vector<ChunkVertex> translucentVertices;
+    // Camera cell translucentVertices were last sorted for
+    glm::ivec3 translucentSortCell = glm::ivec3(0);
+    // Voxels that hide the faces behind them (see occludesFaces) and
+    // translucent ones, keeps the empty/full flags cheap
+    int solidCount = 0;
+    int translucentCount = 0;
+    bool meshDirty = true;
+    // Id of the mesh job in flight for this section, 0 when none
+    unsigned long meshJobId = 0;
+    // Slices per axis changed since the last mesh job, see SectionSnapshot::dirtySlices
+    uint32_t dirtySlices[3] = {ALL_SLICES, ALL_SLICES, ALL_SLICES};
+    // CPU copy of the last mesh, only kept once the section is being edited
+    std::unique_ptr<SectionMeshCache> meshCache;
+    bool keepMeshCache = false;
+
+    // Everything has to be rebuilt (loads, neighbour changes, LOD switches)
+    void markDirty() {
+        meshDirty = true;
+        for (uint32_t& slices : dirtySlices) slices = ALL_SLICES;
+    }
+    // An edit or a light change, only the given slices changed. Edited
+    // sections keep their mesh on the CPU from now on.
+    void markSlicesDirty(uint32_t xSlices, uint32_t ySlices, uint32_t zSlices, bool edited) {
+        meshDirty = true;
+        keepMeshCache |= edited;
+        dirtySlices[0] |= xSlices;
+        dirtySlices[1] |= ySlices;
+        dirtySlices[2] |= zSlices;
+    }
+
+    bool isEmpty() const { return solidCount == 0 && translucentCount == 0; }
+    bool isFull() const { return solidCount == SECTION_VOLUME; }
+};
+
+// Index into Chunk::neighbours
+enum ChunkNeighbour {
+    NEIGHBOUR_NEG_X = 0,
+    NEIGHBOUR_POS_X = 1,
+    NEIGHBOUR_NEG_Z = 2,
+    NEIGHBOUR_POS_Z = 3
+};
+
 class Chunk {
 public:
     ChunkCoord coord;
     InfiniteWorld* world;
+    // Loaded neighbours, kept up to date by InfiniteWorld on load and unload
+    Chunk* neighbours[4];
     vec3 worldPosition;
-    Voxel voxels[CHUNK_SIZE][CHUNK_HEIGHT][CHUNK_SIZE];
-    std::vector<float> vertices;
-    bool meshGenerated, meshDirty;
-    unsigned int VAO, VBO;
+    ChunkSection sections[SECTIONS_PER_CHUNK];
+    // Set when the voxels differ from what's on disk (freshly generated or edited)
+    bool needsSave = true;
+    // Frustum plane that culled this chunk last, see Frustum::classifyBox
+    int cullPlaneHint = 0;
+    // Level of detail the sections are meshed at, picked by InfiniteWorld::render
+    int lod = 0;
+    // InfiniteWorld frame it was last drawn (or adopted), memory eviction goes stalest first
+    unsigned long lastSeenFrame = 0;
 
-    Chunk(ChunkCoord c, InfiniteWorld* w);
+    Chunk(ChunkCoord c = ChunkCoord(), InfiniteWorld* w = nullptr);
     ~Chunk();
+    // Makes a pooled chunk look freshly constructed, meshes must have been freed already
+    void reset(ChunkCoord c, InfiniteWorld* w);
+    // Returns the dense voxel and light arrays to their pool and drops the mesh
+    // caches, so chunks idling in the chunk pool don't hold on to memory
+    void releaseSectionData();
     
     void generateTerrain();
-    void generateMesh();
-    void generateFacesForDirection(int axis, int direction);
-    void addOptimizedQuad(int axis, int direction, int i, int j, int d, int width, int height, int u, int v, int w, VoxelType voxelType);
-    void addFace(int x, int y, int z, int face, vec3 color);
-    void render();
+    void takeSnapshot(int sectionIndex, SectionSnapshot& snapshot);
+    // Local coordinates inside the chunk, setVoxel keeps the section counts in sync
+    VoxelType getVoxel(int x, int y, int z) const {
+        return sections[y / SECTION_SIZE].voxels.get(x, y % SECTION_SIZE, z);
+    }
+    void setVoxel(int x, int y, int z, VoxelType type);
+    // Packed light, see Lighting.h
+    uint8_t getLight(int x, int y, int z) const {
+        return sections[y / SECTION_SIZE].light.get(x, y % SECTION_SIZE, z);
+    }
+    void setLight(int x, int y, int z, uint8_t light) {
+        sections[y / SECTION_SIZE].light.set(x, y % SECTION_SIZE, z, light);
+    }
+    // Sunlight and emitters inside this chunk only, light from the neighbours
+    // is spread in when the world adopts it (InfiniteWorld::spreadBorderLight)
+    void computeLight();
+    void recountSections();
+    void compactSections();
+    // Everything the chunk holds on the CPU: voxels and light (with the chunk
+    // itself) plus the vertices it keeps
+    size_t getMemoryUsage() const;
+    size_t getVoxelMemoryUsage() const;
+    size_t getMeshMemoryUsage() const;
+    // Region file payload: a format version byte, then every section's RLE
+    void serialize(std::vector<uint8_t>& out) const;
+    bool deserialize(const std::vector<uint8_t>& payload);
+    void markAllSectionsDirty();
     bool isVoxelSolidAtPosition(int x, int y, int z);
     VoxelType getVoxelTypeAt(int x, int y, int z);
-    vec3 getVoxelColor(VoxelType type);
-};
\ No newline at end of file
+    // Like getVoxelTypeAt, above the world and unloaded neighbours are in full sunlight
+    uint8_t getLightAt(int x, int y, int z);
+    static vec3 getVoxelColor(VoxelType type);
+
+private:
+    void placeTree(int x, int height, int z);
+};
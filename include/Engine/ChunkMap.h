@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Common.h"
+
+// Open-addressing hash map keyed by ChunkCoord (linear probing, power of two
+// capacity, backward-shift erase so there are no tombstones). Mirrors the bits
+// of the std::map interface the world uses, including `auto& [coord, value]`.
+// Erasing while iterating is not supported, collect the keys first.
+template <typename V>
+class ChunkMap {
+public:
+    struct Slot {
+        ChunkCoord first;
+        V second;
+    };
+
+    class iterator {
+    public:
+        iterator(ChunkMap* map, size_t index) : map(map), index(index) { skipEmpty(); }
+        Slot& operator*() const { return map->slots[index]; }
+        Slot* operator->() const { return &map->slots[index]; }
+        iterator& operator++() { index++; skipEmpty(); return *this; }
+        bool operator==(const iterator& other) const { return index == other.index; }
+        bool operator!=(const iterator& other) const { return index != other.index; }
+
+    private:
+        friend class ChunkMap;
+        void skipEmpty() {
+            while (index < map->slots.size() && !map->used[index]) index++;
+        }
+        ChunkMap* map;
+        size_t index;
+    };
+
+    ChunkMap() : count_(0) { rehash(64); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, slots.size()); }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    iterator find(const ChunkCoord& key) {
+        size_t index = indexOf(key);
+        while (used[index]) {
+            if (slots[index].first == key) return iterator(this, index);
+            index = (index + 1) & mask;
+        }
+        return end();
+    }
+
+    size_t count(const ChunkCoord& key) { return find(key) != end() ? 1 : 0; }
+
+    V& operator[](const ChunkCoord& key) {
+        // Keep the load factor under 0.7
+        if ((count_ + 1) * 10 > slots.size() * 7) rehash(slots.size() * 2);
+
+        size_t index = indexOf(key);
+        while (used[index]) {
+            if (slots[index].first == key) return slots[index].second;
+            index = (index + 1) & mask;
+        }
+        used[index] = true;
+        slots[index].first = key;
+        slots[index].second = V();
+        count_++;
+        return slots[index].second;
+    }
+
+    void erase(iterator it) { eraseAt(it.index); }
+
+    size_t erase(const ChunkCoord& key) {
+        iterator it = find(key);
+        if (it == end()) return 0;
+        eraseAt(it.index);
+        return 1;
+    }
+
+    void clear() {
+        std::fill(used.begin(), used.end(), false);
+        for (Slot& slot : slots) slot.second = V();
+        count_ = 0;
+    }
+
+private:
+    size_t indexOf(const ChunkCoord& key) const { return ChunkCoordHash()(key) & mask; }
+
+    // Pulls later entries of the probe chain back into the hole
+    void eraseAt(size_t hole) {
+        size_t index = hole;
+        while (true) {
+            index = (index + 1) & mask;
+            if (!used[index]) break;
+            size_t home = indexOf(slots[index].first);
+            // Move the entry if its home slot is not between the hole and itself
+            bool between = hole <= index ? (hole < home && home <= index) : (hole < home || home <= index);
+            if (!between) {
+                slots[hole] = std::move(slots[index]);
+                hole = index;
+            }
+        }
+        used[hole] = false;
+        slots[hole].second = V();
+        count_--;
+    }
+
+    void rehash(size_t newCapacity) {
+        std::vector<Slot> oldSlots = std::move(slots);
+        std::vector<bool> oldUsed = std::move(used);
+        slots.assign(newCapacity, Slot());
+        used.assign(newCapacity, false);
+        mask = newCapacity - 1;
+        count_ = 0;
+        for (size_t i = 0; i < oldSlots.size(); i++) {
+            if (oldUsed[i]) (*this)[oldSlots[i].first] = std::move(oldSlots[i].second);
+        }
+    }
+
+    std::vector<Slot> slots;
+    std::vector<bool> used;
+    size_t mask;
+    size_t count_;
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Common.h"
+#include "Engine/Lighting.h"
+
+struct SectionMeshCache;
+
+// Slices along one axis, a bit per slice in the dirty masks below
+constexpr int MAX_SECTION_SLICES = CHUNK_SIZE > SECTION_SIZE ? CHUNK_SIZE : SECTION_SIZE;
+constexpr uint32_t ALL_SLICES = ~0u;
+
+// Copy of one chunk section plus a one voxel border taken from the sections
+// around it. Meshing only ever reads from this, so it can run on a worker
+// thread while the main thread keeps editing the live chunk.
+// One byte per voxel (and one of light, see Lighting.h) so the padded 18^3
+// blocks stay in L1.
+struct SectionSnapshot {
+    static constexpr int PADDED_X = CHUNK_SIZE + 2;
+    static constexpr int PADDED_Y = SECTION_SIZE + 2;
+    static constexpr int PADDED_Z = CHUNK_SIZE + 2;
+
+    ChunkCoord coord;
+    int sectionIndex;
+    // Mesh job this snapshot was taken for, see ChunkSection::meshJobId
+    unsigned long jobId;
+    // Level of detail to mesh at, see downsampleSnapshot()
+    int lod;
+    // Per axis, the slices whose faces have to be rebuilt. Faces in the other
+    // slices are copied from `cache`, the previous mesh of this section.
+    uint32_t dirtySlices[3];
+    std::unique_ptr<SectionMeshCache> cache;
+    // Hand a cache of the new mesh back with the result
+    bool keepCache;
+    uint8_t voxels[PADDED_X][PADDED_Y][PADDED_Z];
+    uint8_t light[PADDED_X][PADDED_Y][PADDED_Z];
+
+    // Section local coordinates, -1 and CHUNK_SIZE/SECTION_SIZE hit the border
+    VoxelType get(int x, int y, int z) const { return VoxelType(voxels[x + 1][y + 1][z + 1]); }
+    void set(int x, int y, int z, VoxelType type) { voxels[x + 1][y + 1][z + 1] = uint8_t(type); }
+    uint8_t getLight(int x, int y, int z) const { return light[x + 1][y + 1][z + 1]; }
+    void setLight(int x, int y, int z, uint8_t value) { light[x + 1][y + 1][z + 1] = value; }
+};
+
+// Padded columns are stored as bits of one uint32 in the binary mesher
+static_assert(SectionSnapshot::PADDED_X <= 32 && SectionSnapshot::PADDED_Y <= 32,
+              "section dimensions too large for 32-bit column masks");
+static_assert(VOXEL_TYPE_COUNT <= 32, "voxel types must fit a 32-bit presence mask");
+
+// Packed vertex position and type, decoded by the vertex shader:
+//   bits  0-4   x (0..CHUNK_SIZE)
+//   bits  5-9   y (0..SECTION_SIZE)
+//   bits 10-14  z (0..CHUNK_SIZE)
+//   bits 15-17  normal index, see normalIndex()
+//   bits 18-25  VoxelType, indexes the palette uniform
+//   bits 26-27  level of detail, positions are scaled by 2^lod
+// Positions are section local, the shader adds the per-draw section origin.
+inline uint32_t packVertex(int x, int y, int z, int normal, VoxelType type, int lod = 0) {
+    return uint32_t(x) | (uint32_t(y) << 5) | (uint32_t(z) << 10) |
+           (uint32_t(normal) << 15) | (uint32_t(type) << 18) | (uint32_t(lod) << 26);
+}
+
+// Lighting word of a vertex:
+//   bits 0-3  block light of the voxel the face looks into
+//   bits 4-7  sky light of that voxel
+//   bits 8-9  ambient occlusion at this corner, 0 = fully occluded, 3 = open
+inline uint32_t packLight(uint8_t light, int occlusion) {
+    return uint32_t(light) | (uint32_t(occlusion) << 8);
+}
+
+struct ChunkVertex {
+    uint32_t data;  // see packVertex
+    uint32_t light; // see packLight
+};
+
+static_assert(LOD_LEVELS <= 4, "level of detail must fit two bits of the packed vertex");
+static_assert(CHUNK_SIZE % (1 << (LOD_LEVELS - 1)) == 0 && SECTION_SIZE % (1 << (LOD_LEVELS - 1)) == 0,
+              "sections must divide evenly at the coarsest level of detail");
+
+// Shrinks the snapshot in place to one cell per 2^lod voxels along each axis,
+// stored from the start of the padded array like a smaller section. A cell is
+// solid when any voxel in it is, and takes the type of its highest solid voxel
+// so grass stays on top. Cells with no solid voxel keep their water. Border
+// cells only see the one voxel layer of padding.
+void downsampleSnapshot(SectionSnapshot& snapshot);
+
+// 0 = +X, 1 = -X, 2 = +Y, 3 = -Y, 4 = +Z, 5 = -Z
+inline int normalIndex(int axis, int direction) {
+    return axis * 2 + (direction < 0 ? 1 : 0);
+}
+
+// Meshes are lists of quads, 4 vertices each, drawn through one shared index
+// buffer with the 0,1,2,0,2,3 pattern. A 3D checkerboard is the worst case.
+constexpr int VERTICES_PER_QUAD = 4;
+constexpr int INDICES_PER_QUAD = 6;
+constexpr int MAX_QUADS_PER_SECTION = SECTION_VOLUME * 3;
+
+// A section mesh on the CPU, vertices grouped by face direction and slice in
+// the order the mesher emits them. Only kept for sections being edited, so
+// their next remesh redoes just the dirty slices (see ChunkSection::meshCache).
+struct SectionMeshCache {
+    std::vector<ChunkVertex> vertices;
+    // Vertices of slice d facing `normal` are [sliceStart[normal][d], sliceStart[normal][d + 1])
+    uint32_t sliceStart[6][MAX_SECTION_SLICES + 1];
+};
+
+static_assert(MAX_SECTION_SLICES <= 32, "slices must fit a 32-bit dirty mask");
+
+// Orders translucent quads back to front as seen from `eye` (section local,
+// in voxels), so blending them in vertex order composites correctly. Quads of
+// one section don't intersect, sorting by their centres is enough.
+void sortTranslucentQuads(std::vector<ChunkVertex>& vertices, const vec3& eye);
+
+// Binary greedy mesher, turns a snapshot into packed vertices (see ChunkVertex).
+// Solid occupancy is stored as one bit column per (u, v) cell along each axis,
+// so finding every visible face of a column is a shift and a mask, and the
+// greedy merge runs on per-type bit rows with count-trailing-zeros. Faces only
+// merge when their light and corner occlusion match too.
+// Translucent voxels (see isTranslucentVoxel) go to their own list for the
+// blended pass. Their faces show against anything but another translucent
+// voxel, and opaque faces behind them are kept.
+class ChunkMesher {
+public:
+    ChunkMesher(const SectionSnapshot& snapshot, std::vector<ChunkVertex>& vertices,
+                std::vector<ChunkVertex>& translucentVertices);
+
+    // With `previous`, opaque slices outside snapshot.dirtySlices are copied
+    // from it instead of being meshed. The result is the same as a full
+    // rebuild. Translucent faces are few and always rebuilt.
+    void generateMesh(const SectionMeshCache* previous = nullptr);
+    // Slice ranges of the mesh just generated, see SectionMeshCache
+    void copySliceStarts(SectionMeshCache& cache) const;
+
+private:
+    bool buildColumns();
+    void generateFacesForDirection(int axis, int direction, bool translucent);
+    uint16_t faceLighting(const int pos[3], int direction, int u, int v, int w) const;
+    void addOptimizedQuad(std::vector<ChunkVertex>& out, int axis, int direction, int i, int j, int d,
+                          int width, int height, int u, int v, int w, VoxelType voxelType, uint16_t lighting);
+
+    const SectionSnapshot& snapshot;
+    std::vector<ChunkVertex>& vertices;
+    std::vector<ChunkVertex>& translucentVertices;
+    const SectionMeshCache* previous;
+    uint32_t sliceStart[6][MAX_SECTION_SLICES + 1];
+    // columns[axis][v][u], bit w set when the padded voxel hides faces (see
+    // occludesFaces), translucentColumns the same for translucent voxels
+    uint32_t columns[3][32][32];
+    uint32_t translucentColumns[3][32][32];
+};
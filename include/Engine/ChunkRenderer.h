@@ -0,0 +1,93 @@
+#pragma once
+#include "Common.h"
+#include "Engine/BufferArena.h"
+#include "Engine/ChunkMesher.h"
+#include "Engine/OcclusionCuller.h"
+
+// Where a section mesh lives inside the shared vertex arena
+struct MeshAllocation {
+    uint32_t offset = 0;      // in vertices
+    uint32_t vertexCount = 0; // 0 means no mesh
+};
+
+// Owns one big vertex buffer that every section mesh is suballocated from and
+// draws all visible sections with a single glMultiDrawElementsIndirect call.
+// The section origin reaches the shader as an instanced attribute, each draw
+// command's baseInstance indexes into the per-frame origin buffer.
+// Translucent meshes go through a second multi-draw after the opaque one,
+// sorted back to front and blended without writing depth.
+class ChunkRenderer {
+public:
+    ChunkRenderer();
+    ~ChunkRenderer();
+
+    // Replaces whatever `mesh` pointed at, main thread only
+    void uploadMesh(MeshAllocation& mesh, const std::vector<ChunkVertex>& vertices);
+    // Rewrites a mesh in place when the vertex count didn't change (re-sorted
+    // translucent quads), uploads it like uploadMesh otherwise
+    void updateMesh(MeshAllocation& mesh, const std::vector<ChunkVertex>& vertices);
+    void freeMesh(MeshAllocation& mesh);
+
+    void beginFrame();
+    void addDraw(const MeshAllocation& mesh, const vec3& origin);
+    // `distanceSquared` to the camera orders the translucent draws, furthest first
+    void addTranslucentDraw(const MeshAllocation& mesh, const vec3& origin, float distanceSquared);
+    // Opaque pass, also streams the translucent commands for drawTranslucent()
+    void draw();
+    // Feeds next frame's occlusion test, call once the opaque geometry is in the depth buffer
+    void captureDepth(const mat4& viewProj);
+    // Blended pass, call after draw() and captureDepth()
+    void drawTranslucent();
+
+    // Keeps the arena bookkeeping but never touches GL, for running without a context (VoxelBench)
+    void setHeadless(bool enabled) { headless = enabled; }
+    void setOcclusionCulling(bool enabled);
+    bool isOcclusionCullingEnabled() const { return occlusionCulling; }
+    int getOccludedCount() const { return occlusionCulling ? occlusion.getOccludedCount() : 0; }
+
+    int getDrawCount() const { return int(commands.size() + translucentDraws.size()); }
+    long getTriangleCount() const { return triangleCount; }
+    const BufferArena& getArena() const { return arena; }
+
+private:
+    struct DrawElementsIndirectCommand {
+        uint32_t count;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;
+    };
+    struct TranslucentDraw {
+        DrawElementsIndirectCommand command;
+        vec3 origin;
+        float distanceSquared;
+    };
+
+    static DrawElementsIndirectCommand makeCommand(const MeshAllocation& mesh);
+
+    void init();
+    void growVertexBuffer(uint32_t minCapacity);
+    void createQuadIndexBuffer();
+    // Orphans and refills a per-frame buffer, only reallocating when it has to grow
+    void streamBuffer(GLenum target, GLuint buffer, size_t& capacity, const void* data, size_t size);
+
+    bool initialized;
+    bool headless;
+    GLuint VAO;
+    GLuint vertexBuffer;
+    GLuint quadIndexBuffer;
+    GLuint originBuffer;
+    GLuint indirectBuffer;
+    size_t originCapacity;
+    size_t indirectCapacity;
+    BufferArena arena;
+    OcclusionCuller occlusion;
+    bool occlusionCulling;
+
+    long triangleCount;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<vec3> origins;
+    std::vector<TranslucentDraw> translucentDraws;
+    // Opaque commands in the indirect buffer this frame, the translucent ones follow
+    size_t opaqueCommandCount;
+};
@@ -1,15 +1,68 @@
 #pragma once
-#include <map>
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include "Common.h"
 #include "Engine/Chunk.h"
 #include "Engine/Camera.h"
+#include "Engine/ChunkMap.h"
+#include "Engine/ChunkMesher.h"
+#include "Engine/ChunkRenderer.h"
+#include "Engine/ObjectPool.h"
+#include "Engine/RegionFile.h"
+#include "Engine/ThreadPool.h"
+#include "Engine/VoxelEditBatch.h"
+#include "Engine/WorldSettings.h"
 #include "Frustum.h"
 
+// Result of InfiniteWorld::raycast
+struct RaycastHit {
+    glm::ivec3 voxel;
+    // Face the ray entered through, voxel + normal is the cell in front of it.
+    // Zero when the ray started inside the voxel.
+    glm::ivec3 normal;
+    VoxelType type;
+    float distance;
+};
+
+// What the world holds, refreshed by every update(). The total is what
+// settings.memoryBudget is checked against.
+struct WorldMemoryStats {
+    size_t voxelBytes = 0;   // voxels, light and the chunk objects
+    size_t cpuMeshBytes = 0; // vertices kept on the CPU, translucent sorting and edit caches
+    size_t gpuMeshBytes = 0; // vertex arena in use
+    // What the arena holds on the GPU. It never shrinks, so it's only shown
+    // and not counted, a budget below its high water mark could never be met.
+    size_t gpuMeshCapacityBytes = 0;
+    size_t retainedBytes = 0;
+    int retainedChunks = 0;
+    // Since the world was created
+    long evictedChunks = 0;  // unloaded early to get under the budget
+    long restoredChunks = 0; // loaded back from a retained copy
+
+    size_t getTotal() const { return voxelBytes + cpuMeshBytes + gpuMeshBytes + retainedBytes; }
+};
+
+// Axis aligned box in world space for the batched overlap queries
+struct VoxelBox {
+    vec3 min;
+    vec3 max;
+};
+
 class InfiniteWorld {
 public:
-    std::map<ChunkCoord, Chunk*> chunks;
+    ChunkMap<Chunk*> chunks;
     ChunkCoord lastPlayerChunk;
     Frustum frustum;
+    ChunkRenderer renderer;
+    WorldSettings settings;
+    // Chunks whose nearest point is further than this (in blocks, horizontally)
+    // aren't drawn, follows the render distance in update()
+    float maxDrawDistance = (RENDER_DISTANCE + 0.5f) * CHUNK_SIZE;
+    // Mesh distant chunks at lower resolution, see LOD_LEVELS
+    bool levelOfDetail = true;
+    // Load and save chunks under saves/<seed>, VoxelBench turns this off to always generate
+    bool persistChunks = true;
 
     InfiniteWorld();
     ~InfiniteWorld();
@@ -18,11 +71,174 @@ public:
     void update(const Camera& camera);
     void loadChunk(ChunkCoord coord);
     void loadChunksAroundPlayer(ChunkCoord playerChunk);
+    void streamChunks(const Camera& camera, std::chrono::steady_clock::time_point deadline);
     void unloadDistantChunks(ChunkCoord playerChunk);
-    void render(const glm::mat4& viewProj);
+    // Saves the chunk, keeps a compressed copy of it (see retainedChunks) and frees it
+    void unloadChunk(Chunk* chunk);
+    void processFinishedChunks();
+    void processFinishedChunks(std::chrono::steady_clock::time_point deadline);
+    void scheduleMeshJobs();
+    bool isSectionHidden(Chunk* chunk, int sectionIndex);
+    void uploadFinishedMeshes();
+    void linkNeighbours(Chunk* chunk);
+    void spreadBorderLight(Chunk* chunk);
+    void saveChunk(Chunk* chunk);
+    void destroyChunk(Chunk* chunk);
+    void render(const glm::mat4& viewProj, const glm::vec3& cameraPosition);
+    int selectLod(const Chunk* chunk, const glm::vec3& cameraPosition) const;
+    void updateLevelsOfDetail(const glm::vec3& cameraPosition);
+    // Once per frame with the last frame's CPU time and the world's memory,
+    // steps quality when settings.adaptiveQuality is on (see WorldSettings)
+    void adaptQuality(float frameMs, size_t memoryBytes);
+    // What adaptive quality settled on, settings.renderDistance at most
+    int getRenderDistance() const { return activeRenderDistance; }
+    float getLodDistanceScale() const { return lodDistanceScale; }
     bool isVoxelSolidAt(int worldX, int worldY, int worldZ);
     void setVoxel(int worldX, int worldY, int worldZ, VoxelType type);
+    // Applies every edit in the batch, returns how many voxels actually changed
+    int applyEdits(VoxelEditBatch& batch);
     void markNeighbourChunksDirty(ChunkCoord coord);
     int getLoadedChunkCount() const;
+    int getPendingChunkCount() const;
+    int getRequestedChunkCount() const;
+    // Sections waiting for a mesh job or for their result to be uploaded
+    int getPendingMeshCount();
+    size_t getVoxelMemoryUsage();
+    const WorldMemoryStats& getMemoryStats() const { return memoryStats; }
+    bool isAreaLoaded(ChunkCoord center, int radius);
     VoxelType getVoxelTypeAt(int worldX, int worldY, int worldZ);
-};
\ No newline at end of file
+
+    // Spatial queries against solid voxels (see isSolidVoxel), unloaded chunks
+    // read as air. None of them allocate, collectSolidVoxels appends to `out`.
+    bool raycast(const vec3& origin, const vec3& direction, float maxDistance, RaycastHit& hit);
+    bool boxOverlapsSolid(const vec3& min, const vec3& max);
+    bool sphereOverlapsSolid(const vec3& center, float radius);
+    // One result per box or sphere (xyz center, w radius), sharing the chunk lookups
+    void overlapBoxes(const VoxelBox* boxes, size_t count, bool* results);
+    void overlapSpheres(const vec4* spheres, size_t count, bool* results);
+    void collectSolidVoxels(const vec3& min, const vec3& max, std::vector<glm::ivec3>& out);
+
+private:
+    friend class WorldLightVolume;
+
+    ChunkStorage storage;
+    // Dirties the section holding a just edited (or relit) voxel and any section that shares its faces
+    void markVoxelDirty(Chunk* chunk, int localX, int localY, int localZ, bool edited = true);
+    // Floodfill light around voxels whose type just changed, see Lighting.h
+    void relightVoxels(const glm::ivec3* voxels, size_t count);
+    LightQueues lightQueues;
+    // Camera position of the last render, new chunks start at the level it implies
+    glm::vec3 lodCameraPosition;
+
+    // Settings as currently applied, update() catches up when they change
+    int activeRenderDistance;
+    int loadedRenderDistance; // what loadChunksAroundPlayer last used
+    float lodDistanceScale;
+    float smoothedFrameMs;
+    int framesSinceAdapt;
+    int appliedWorkerThreads;
+    int appliedColumnCacheDistance; // ColumnCache is sized for this many chunks out
+    bool isChunkInRange(ChunkCoord coord, ChunkCoord playerChunk) const;
+
+    // Counts update() calls, stamps Chunk::lastSeenFrame
+    unsigned long frameIndex;
+    WorldMemoryStats memoryStats;
+    std::vector<Chunk*> unloadCandidates; // reused by unloadDistantChunks and enforceMemoryBudget
+    void updateMemoryStats();
+    void enforceMemoryBudget(ChunkCoord playerChunk);
+
+    // Serialized (RLE) copies of recently unloaded chunks. loadChunk takes one
+    // back before trying the region files or the generator. retainedOrder
+    // lists them oldest first, entries whose serial no longer matches are stale.
+    using RetainedPayload = std::shared_ptr<const std::vector<uint8_t>>;
+    struct RetainedChunk {
+        RetainedPayload payload;
+        unsigned long serial;
+    };
+    ChunkMap<RetainedChunk> retainedChunks;
+    std::deque<std::pair<ChunkCoord, unsigned long>> retainedOrder;
+    unsigned long nextRetainSerial;
+    void retainChunk(Chunk* chunk);
+    RetainedPayload takeRetainedChunk(ChunkCoord coord);
+    // Drops the oldest copies until they fit in `limit` bytes
+    void trimRetainedChunks(size_t limit);
+
+    // Loaded chunks bucketed by region so render() can accept or reject a
+    // whole region with one frustum test before looking at its chunks
+    struct CullRegion {
+        std::vector<Chunk*> chunks;
+        int planeHint = 0;
+    };
+    ChunkMap<CullRegion> cullRegions;
+    static ChunkCoord cullRegionOf(ChunkCoord coord);
+    void addToCullRegion(Chunk* chunk);
+    void removeFromCullRegion(Chunk* chunk);
+
+    // Recycled chunks, snapshots and vertex vectors so steady streaming doesn't allocate
+    ObjectPool<Chunk> chunkPool;
+    ObjectPool<SectionSnapshot> snapshotPool;
+    std::mutex vertexBufferMutex;
+    std::vector<std::vector<ChunkVertex>> spareVertexBuffers;
+    std::vector<ChunkVertex> takeVertexBuffer();
+    void recycleVertexBuffer(std::vector<ChunkVertex>&& vertices);
+
+    // Terrain generation runs on the pool, finished chunks wait in
+    // finishedChunks until the main thread adopts them in update()
+    ThreadPool workers;
+    ChunkMap<bool> pendingChunks;
+    // Missing chunks around the player, handed to loadChunk() a few at a time
+    // in order of distance and visibility by streamChunks()
+    struct LoadRequest {
+        ChunkCoord coord;
+        float priority; // lower loads first
+    };
+    std::vector<LoadRequest> loadRequests;
+    std::mutex finishedMutex;
+    std::vector<Chunk*> finishedChunks;
+    std::vector<Chunk*> adoptingChunks; // swapped with finishedChunks, keeps both capacities
+
+    // Meshes built on the pool, uploaded a few per frame by uploadFinishedMeshes()
+    struct MeshResult {
+        ChunkCoord coord;
+        int sectionIndex;
+        unsigned long jobId;
+        std::vector<ChunkVertex> vertices;
+        std::vector<ChunkVertex> translucentVertices;
+        std::unique_ptr<SectionMeshCache> cache; // set when the section keeps a CPU copy
+    };
+    unsigned long nextMeshJobId;
+    std::mutex finishedMeshMutex;
+    std::vector<MeshResult> finishedMeshes;
+    std::vector<MeshResult> readyMeshes; // oldest first
+};
+
+// World voxel lookups that remember the last chunk. Stepping into the chunk
+// next door goes through its neighbour pointers, so walking a ray or a box
+// only touches the chunk map when it jumps further. Main thread only, and
+// only valid until chunks are loaded or unloaded.
+class VoxelCursor {
+public:
+    explicit VoxelCursor(InfiniteWorld& world) : world(world), chunk(nullptr), coord(), valid(false) {}
+
+    VoxelType get(int worldX, int worldY, int worldZ) {
+        if (worldY < 0 || worldY >= CHUNK_HEIGHT) return AIR;
+        Chunk* target = getChunk(worldX, worldZ);
+        if (!target) return AIR;
+        return target->getVoxel(worldToLocal(worldX), worldY, worldToLocal(worldZ));
+    }
+
+    // Chunk holding the world column, nullptr if it isn't loaded
+    Chunk* getChunk(int worldX, int worldZ) {
+        ChunkCoord target(worldToChunk(worldX), worldToChunk(worldZ));
+        if (!valid || !(target == coord)) moveTo(target);
+        return chunk;
+    }
+
+private:
+    void moveTo(ChunkCoord target);
+
+    InfiniteWorld& world;
+    Chunk* chunk;
+    ChunkCoord coord;
+    bool valid;
+};
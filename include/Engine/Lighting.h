@@ -0,0 +1,155 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Common.h"
+#include "Engine/VoxelStorage.h"
+
+// Light levels run 0..MAX_LIGHT and drop by one per voxel. Each voxel packs
+// block light (from emitters) in the low nibble and sky light in the high one.
+// Sky light at full strength travels straight down without dropping, so open
+// columns stay fully lit all the way to the ground.
+constexpr int MAX_LIGHT = 15;
+constexpr uint8_t FULL_SKY_LIGHT = MAX_LIGHT << 4;
+
+enum LightChannel {
+    LIGHT_BLOCK = 0,
+    LIGHT_SKY = 1
+};
+
+inline int getLightLevel(uint8_t light, LightChannel channel) {
+    return channel == LIGHT_SKY ? light >> 4 : light & 0x0F;
+}
+
+inline uint8_t setLightLevel(uint8_t light, LightChannel channel, int level) {
+    return channel == LIGHT_SKY ? uint8_t((light & 0x0F) | (level << 4)) : uint8_t((light & 0xF0) | level);
+}
+
+// Light stops at opaque voxels (see BlockTable), emitters light their own voxel
+inline bool isOpaqueVoxel(VoxelType type) {
+    return BLOCK_TABLE.flags[type] & BLOCK_OPAQUE;
+}
+
+inline int getVoxelEmission(VoxelType type) {
+    return BLOCK_TABLE.emission[type];
+}
+
+// Packed light of one chunk section, same layout as VoxelStorage and dense
+// arrays from the same free list. Sections the sun fills completely (or that
+// are buried in the dark) stay uniform. Light isn't saved, it is recomputed
+// whenever a chunk loads.
+class LightStorage {
+public:
+    uint8_t get(int x, int y, int z) const {
+        return data ? data[indexOf(x, y, z)] : uniformLight;
+    }
+    void set(int x, int y, int z, uint8_t light) {
+        if (!data) {
+            if (light == uniformLight) return;
+            data.reset(VoxelStorage::acquireBuffer());
+            std::fill_n(data.get(), SECTION_VOLUME, uniformLight);
+        }
+        data[indexOf(x, y, z)] = light;
+    }
+    void fill(uint8_t light) {
+        data.reset();
+        uniformLight = light;
+    }
+    bool compact() {
+        if (!data) return false;
+        for (int i = 1; i < SECTION_VOLUME; i++) {
+            if (data[i] != data[0]) return false;
+        }
+        fill(data[0]);
+        return true;
+    }
+    size_t getMemoryUsage() const { return data ? SECTION_VOLUME : 0; }
+
+private:
+    static int indexOf(int x, int y, int z) {
+        return (y * CHUNK_SIZE + z) * CHUNK_SIZE + x;
+    }
+
+    uint8_t uniformLight = 0;
+    VoxelStorage::Buffer data;
+};
+
+// Breadth first floodfill shared by chunk generation (one chunk, local
+// coordinates) and edits (the loaded world). A Volume provides:
+//   bool contains(x, y, z)              voxel exists and can be relit
+//   bool isTransparent(x, y, z)         contains() and light passes through
+//   int getLight(x, y, z, channel)
+//   void setLight(x, y, z, channel, level)
+//   int getEmission(x, y, z)
+struct LightNode {
+    int x, y, z;
+    int level; // light the voxel had before removal, unused when adding
+};
+
+// Reused between floodfills so a stream of edits doesn't allocate
+struct LightQueues {
+    std::vector<LightNode> add;
+    std::vector<LightNode> remove;
+};
+
+constexpr int LIGHT_DIRECTIONS[6][3] = {
+    {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+};
+constexpr int LIGHT_DOWN = 3;
+
+// Spreads light outwards from every voxel in queues.add (already lit)
+template <typename Volume>
+void propagateLight(Volume& volume, LightChannel channel, LightQueues& queues) {
+    for (size_t n = 0; n < queues.add.size(); n++) {
+        LightNode node = queues.add[n];
+        int level = volume.getLight(node.x, node.y, node.z, channel);
+        if (level <= 1) continue;
+
+        for (int d = 0; d < 6; d++) {
+            int x = node.x + LIGHT_DIRECTIONS[d][0];
+            int y = node.y + LIGHT_DIRECTIONS[d][1];
+            int z = node.z + LIGHT_DIRECTIONS[d][2];
+            int spread = (channel == LIGHT_SKY && d == LIGHT_DOWN && level == MAX_LIGHT) ? MAX_LIGHT : level - 1;
+            if (spread <= 0 || !volume.isTransparent(x, y, z)) continue;
+            if (volume.getLight(x, y, z, channel) >= spread) continue;
+            volume.setLight(x, y, z, channel, spread);
+            queues.add.push_back({x, y, z, 0});
+        }
+    }
+    queues.add.clear();
+}
+
+// Darkens everything that was lit through the voxels in queues.remove (already
+// set to 0, `level` holding what they had), then refills the hole from the
+// brighter light around it and from any emitters it reached
+template <typename Volume>
+void removeLight(Volume& volume, LightChannel channel, LightQueues& queues) {
+    for (size_t n = 0; n < queues.remove.size(); n++) {
+        LightNode node = queues.remove[n];
+        for (int d = 0; d < 6; d++) {
+            int x = node.x + LIGHT_DIRECTIONS[d][0];
+            int y = node.y + LIGHT_DIRECTIONS[d][1];
+            int z = node.z + LIGHT_DIRECTIONS[d][2];
+            if (!volume.contains(x, y, z)) continue;
+            int level = volume.getLight(x, y, z, channel);
+            if (level == 0) continue;
+
+            bool litFromHere = level < node.level ||
+                               (channel == LIGHT_SKY && d == LIGHT_DOWN && node.level == MAX_LIGHT);
+            if (!litFromHere) {
+                queues.add.push_back({x, y, z, 0});
+                continue;
+            }
+            volume.setLight(x, y, z, channel, 0);
+            queues.remove.push_back({x, y, z, level});
+            int emission = channel == LIGHT_BLOCK ? volume.getEmission(x, y, z) : 0;
+            if (emission > 0) {
+                volume.setLight(x, y, z, channel, emission);
+                queues.add.push_back({x, y, z, 0});
+            }
+        }
+    }
+    queues.remove.clear();
+    propagateLight(volume, channel, queues);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Thread-safe free list of heap objects that are expensive to allocate
+// (chunks, section snapshots). acquire() hands out a recycled object when
+// there is one, so callers must reset whatever state they rely on. The pool
+// owns every object it ever created, anything still checked out when it is
+// destroyed (e.g. the snapshot of a dropped job) is freed with it.
+template <typename T>
+class ObjectPool {
+public:
+    explicit ObjectPool(size_t maxObjects) : maxObjects(maxObjects) {
+        freeObjects.reserve(maxObjects);
+    }
+
+    T* acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeObjects.empty()) {
+            T* object = freeObjects.back();
+            freeObjects.pop_back();
+            return object;
+        }
+        objects.emplace_back(new T());
+        return objects.back().get();
+    }
+
+    // Past maxObjects spares the object is freed instead of kept
+    void release(T* object) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeObjects.size() < maxObjects) {
+            freeObjects.push_back(object);
+            return;
+        }
+        for (size_t i = 0; i < objects.size(); i++) {
+            if (objects[i].get() == object) {
+                objects[i] = std::move(objects.back());
+                objects.pop_back();
+                return;
+            }
+        }
+    }
+
+    size_t getObjectCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return objects.size();
+    }
+    size_t getFreeCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return freeObjects.size();
+    }
+
+private:
+    std::mutex mutex;
+    size_t maxObjects;
+    std::vector<std::unique_ptr<T>> objects;
+    std::vector<T*> freeObjects;
+};
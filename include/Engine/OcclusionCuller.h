@@ -0,0 +1,49 @@
+#pragma once
+#include "Common.h"
+
+// Hi-Z occlusion culling for the multi-draw renderer. After the opaque pass
+// the depth buffer is copied and reduced into a max-depth mip pyramid. Next
+// frame a compute pass projects every draw's section box with that frame's
+// matrix and zeroes instanceCount in the indirect buffer for boxes behind the
+// pyramid, so hidden sections never reach the vertex stage. Results lag one
+// frame, the usual price for not stalling on the GPU.
+class OcclusionCuller {
+public:
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    // false if the compute shaders failed to build, culling is then skipped
+    bool isSupported();
+    // Rewrites instanceCount of `drawCount` commands in `indirectBuffer` in place,
+    // `originBuffer` holds one tightly packed vec3 section origin per draw
+    void cull(GLuint indirectBuffer, GLuint originBuffer, int drawCount);
+    // Copies the current depth buffer, call after the opaque geometry is drawn
+    void captureDepth(const mat4& viewProj);
+    void invalidate() { hasDepth = false; }
+
+    // Draws the cull pass rejected, read back a few frames late
+    int getOccludedCount() const { return occludedCount; }
+
+private:
+    static constexpr int COUNTER_BUFFERS = 3;
+
+    bool init();
+    void resize(int newWidth, int newHeight);
+
+    bool initialized;
+    bool supported;
+    bool hasDepth;
+    int width, height, levels;
+    mat4 depthViewProj;
+
+    GLuint depthTexture;
+    GLuint pyramidTexture;
+    GLuint copyProgram;
+    GLuint reduceProgram;
+    GLuint cullProgram;
+
+    GLuint counterBuffers[COUNTER_BUFFERS];
+    bool counterPending[COUNTER_BUFFERS];
+    int counterIndex;
+    int occludedCount;
+};
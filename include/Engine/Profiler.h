@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+// Fixed set of timed scopes, cheap enough to leave on in release builds
+enum ProfileScope {
+    PROFILE_WORLD_UPDATE,
+    PROFILE_TERRAIN_GENERATION,
+    PROFILE_MESHING,
+    PROFILE_MESH_UPLOAD,
+    PROFILE_RENDER,
+    PROFILE_SCOPE_COUNT
+};
+
+// Per-frame counters, filled in by the world and renderer on the main thread
+struct FrameCounters {
+    int drawCalls = 0;
+    long triangles = 0;
+    int visibleChunks = 0;
+    int culledChunks = 0;
+    int visibleSections = 0;
+    int culledSections = 0;
+    int occludedSections = 0; // lags a few frames, see OcclusionCuller
+    int chunksLoaded = 0;   // adopted from the workers, generated or read from disk
+    int meshesUploaded = 0;
+    size_t bytesUploaded = 0;
+    size_t meshMemory = 0;
+    size_t voxelMemory = 0;
+};
+
+// CPU scope timers, frame time history and an optional Chrome trace capture
+// (load the JSON in chrome://tracing or Perfetto). Scopes may be timed from
+// worker threads, their time is summed into whichever frame they end in.
+class Profiler {
+public:
+    static constexpr int HISTORY_SIZE = 240;
+
+    static Profiler& get();
+    static const char* getScopeName(ProfileScope scope);
+
+    void beginFrame();
+    void endFrame();
+
+    void addScopeTime(ProfileScope scope, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end);
+
+    FrameCounters& getCounters() { return counters; }
+    const FrameCounters& getLastCounters() const { return lastCounters; }
+    // Milliseconds spent in `scope` during the last finished frame (summed over threads)
+    float getScopeTime(ProfileScope scope) const { return lastScopeTimes[scope]; }
+    int getScopeCount(ProfileScope scope) const { return lastScopeCounts[scope]; }
+
+    // Frame times in milliseconds, oldest first
+    const float* getFrameHistory() const { return frameHistory; }
+    int getHistoryOffset() const { return historyIndex; }
+    float getFramePercentile(float percentile) const;
+    float getLastFrameTime() const { return frameHistory[(historyIndex + HISTORY_SIZE - 1) % HISTORY_SIZE]; }
+
+    void setGpuTime(float milliseconds) { gpuTime = milliseconds; }
+    float getGpuTime() const { return gpuTime; }
+
+    // Records every scope for the next `frames` frames, then writes `path`
+    void captureTrace(int frames, const std::string& path);
+    bool isCapturing() const { return captureFramesLeft > 0; }
+
+private:
+    Profiler();
+
+    struct TraceEvent {
+        ProfileScope scope;
+        unsigned int thread;
+        long long start; // microseconds since the profiler was created
+        long long duration;
+    };
+
+    void writeTrace();
+
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point frameStart;
+
+    std::atomic<long long> scopeNanoseconds[PROFILE_SCOPE_COUNT];
+    std::atomic<int> scopeCounts[PROFILE_SCOPE_COUNT];
+    float lastScopeTimes[PROFILE_SCOPE_COUNT];
+    int lastScopeCounts[PROFILE_SCOPE_COUNT];
+
+    FrameCounters counters;
+    FrameCounters lastCounters;
+    float gpuTime;
+
+    float frameHistory[HISTORY_SIZE];
+    int historyIndex;
+    int historyCount;
+
+    std::atomic<int> captureFramesLeft;
+    std::string capturePath;
+    std::mutex traceMutex;
+    std::vector<TraceEvent> traceEvents;
+};
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ProfileScope scope)
+        : scope(scope), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        Profiler::get().addScopeTime(scope, start, std::chrono::steady_clock::now());
+    }
+
+private:
+    ProfileScope scope;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(scope) ScopedTimer PROFILE_CONCAT(scopedTimer, __LINE__)(scope)
+
+// GL_TIME_ELAPSED queries in a small ring so reading a result never stalls,
+// the time reported lags a few frames behind. Main thread only.
+class GpuTimer {
+public:
+    static constexpr int QUERY_COUNT = 4;
+
+    GpuTimer();
+    ~GpuTimer();
+
+    void begin();
+    void end();
+    // Latest finished measurement in milliseconds
+    float getTime() const { return lastTime; }
+
+private:
+    void init();
+
+    bool initialized;
+    GLuint queries[QUERY_COUNT];
+    bool pending[QUERY_COUNT];
+    int current;
+    float lastTime;
+};
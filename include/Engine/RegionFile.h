@@ -0,0 +1,97 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Common.h"
+#include "Engine/ChunkMap.h"
+#include "Engine/ThreadPool.h"
+
+class Chunk;
+
+constexpr int REGION_CHUNKS = 32;
+
+// One file holding up to 32x32 chunk payloads. The header is a magic, a
+// version and an offset table of (offset, size) pairs, payloads follow in
+// any order. A rewritten chunk reuses its old slot if it still fits and is
+// appended otherwise. Reads go through a memory mapping of the whole file
+// (plain reads on Windows), writes through stdio. Not thread safe on its own.
+class RegionFile {
+public:
+    explicit RegionFile(const std::string& path);
+    ~RegionFile();
+
+    bool isOpen() const { return file != nullptr; }
+    bool has(int localX, int localZ) const;
+    bool read(int localX, int localZ, std::vector<uint8_t>& out);
+    bool write(int localX, int localZ, const std::vector<uint8_t>& payload);
+
+private:
+    struct Entry {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    static constexpr uint32_t MAGIC = 0x47525856; // "VXRG"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr long HEADER_SIZE = 8 + REGION_CHUNKS * REGION_CHUNKS * sizeof(Entry);
+
+    bool readHeader();
+    bool writeHeader();
+    bool ensureMapped(size_t size);
+    void unmap();
+
+    std::string path;
+    FILE* file;
+    Entry entries[REGION_CHUNKS * REGION_CHUNKS];
+    const uint8_t* mapped;
+    size_t mappedSize;
+};
+
+// Saved chunks of one world, a directory of region files. Writes are queued
+// to a single background thread; a chunk that's reloaded while its write is
+// still queued is served from the queue. loadChunk may be called from any thread.
+// The directory is only created by the first write, a world that never saves
+// leaves nothing behind.
+class ChunkStorage {
+public:
+    explicit ChunkStorage(const std::string& directory);
+    ~ChunkStorage();
+
+    // One directory per world seed, e.g. saves/12345
+    static std::string directoryForSeed(unsigned int seed);
+
+    // Fills `chunk` from disk, returns false if the chunk was never saved
+    bool loadChunk(ChunkCoord coord, Chunk& chunk);
+    void saveChunkAsync(ChunkCoord coord, std::vector<uint8_t> payload);
+    // Blocks until every queued write has hit the file
+    void flush();
+    size_t getPendingWriteCount();
+
+private:
+    using Payload = std::shared_ptr<const std::vector<uint8_t>>;
+
+    // A region file and the lock held while reading or writing it, so a
+    // write only holds up loads from the same region. `file` stays null for
+    // regions that didn't exist until the first write creates them.
+    struct Region {
+        std::mutex mutex;
+        std::unique_ptr<RegionFile> file;
+    };
+
+    std::string regionPath(ChunkCoord regionCoord) const;
+    // Expects `mutex` to be held, the region's own lock guards its file
+    Region* getRegion(ChunkCoord regionCoord);
+    void writePending(ChunkCoord coord, Payload payload);
+
+    std::string directory;
+    // Guards `regions` and `pendingWrites`, never held during file I/O
+    std::mutex mutex;
+    std::condition_variable writesDone;
+    ChunkMap<Region*> regions;
+    ChunkMap<Payload> pendingWrites;
+    ThreadPool writer;
+};
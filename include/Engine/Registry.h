@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include "Common.h"
+
+// Block properties and biomes come from a small text file (see
+// assets/registry.cfg) loaded once at startup and compiled into BLOCK_TABLE
+// and the biome list. They are read without locks by the worker threads, so
+// load before the first chunk is generated and never again after.
+struct BlockDefinition {
+    VoxelType type;
+    bool solid;
+    bool translucent;
+    bool opaque;
+    int emission;
+    vec3 color;
+};
+
+// Name of a voxel type in the registry file, "stone", "leaves", ...
+const char* getVoxelName(VoxelType type);
+bool voxelTypeFromName(const char* name, VoxelType& type);
+
+BlockTable compileBlockTable(const BlockDefinition* definitions, int count);
+
+// false (with a message) when the file is missing or has a bad line, the
+// built in definitions stay in place then
+bool loadRegistry(const std::string& path);
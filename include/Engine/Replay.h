@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Common.h"
+
+class Camera;
+
+// Replays run at a fixed timestep so every run renders the same frames
+constexpr float REPLAY_TIMESTEP = 1.0f / 60.0f;
+
+struct CameraKeyframe {
+    float time; // seconds from the start of the path
+    vec3 position;
+    float yaw;
+    float pitch;
+};
+
+// Recorded camera route. Text file, one "time x y z yaw pitch" keyframe per
+// line, # starts a comment. Sampling interpolates linearly between keyframes.
+class CameraPath {
+public:
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Keyframes must be added in time order
+    void addKeyframe(float time, const Camera& camera);
+    // Moves the camera to where the path is at `time`, false once past the end
+    bool apply(float time, Camera& camera) const;
+
+    float getDuration() const { return keyframes.empty() ? 0.0f : keyframes.back().time; }
+    bool isEmpty() const { return keyframes.empty(); }
+
+    // Built in benchmark route: a 1600 block square at 100 blocks/s, so it
+    // crosses a chunk border roughly every 0.16s in a straight line
+    static CameraPath standardRoute();
+
+private:
+    std::vector<CameraKeyframe> keyframes;
+};
+
+// Per-frame measurements written by a replay
+struct ReplayFrame {
+    int frame;
+    float time;
+    float cpuTime;    // ms, whole frame on the main thread
+    float gpuTime;    // ms, lags a few frames, see GpuTimer
+    float updateTime; // ms in InfiniteWorld::update
+    float renderTime; // ms in InfiniteWorld::render
+    int chunksLoaded;
+    int meshesUploaded;
+    int drawCalls;
+    long triangles;
+};
+
+// Streams replay frames to a CSV file and keeps them for the summary
+class ReplayLog {
+public:
+    ReplayLog() : file(nullptr) {}
+    ~ReplayLog();
+
+    bool open(const std::string& path);
+    void addFrame(const ReplayFrame& frame);
+    void close();
+
+    // Percentile (0-100) of the per-frame CPU time
+    float getCpuPercentile(float percentile) const;
+    void printSummary() const;
+
+private:
+    FILE* file;
+    std::vector<ReplayFrame> frames;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include "Common.h"
+
+// Set by CMake, relative to the working directory otherwise
+#ifndef VOXEL_ASSET_DIR
+#define VOXEL_ASSET_DIR "assets"
+#endif
+
+// Voxel textures live in one GL_TEXTURE_2D_ARRAY, a layer per voxel type and
+// face, so the whole world draws with a single bind. The shader picks the
+// layer from the packed vertex and tiles by world position, which keeps
+// greedy quads at one texel per voxel.
+constexpr int VOXEL_TEXTURE_SIZE = 16;
+constexpr int TEXTURE_FACES = 3;
+
+enum TextureFace {
+    TEXTURE_FACE_TOP = 0,
+    TEXTURE_FACE_SIDE = 1,
+    TEXTURE_FACE_BOTTOM = 2
+};
+
+inline int textureLayer(VoxelType type, TextureFace face) {
+    return int(type) * TEXTURE_FACES + int(face);
+}
+
+// RGBA8 texels of every layer, layer after layer, rows bottom up (v = 0 is the
+// bottom of a side face). Stored on disk as a small header and the raw texels
+// so loading is a single read.
+struct TextureAtlasData {
+    int size = 0;
+    int layers = 0;
+    std::vector<uint8_t> texels;
+
+    // false (with a message) when the file is missing, malformed or was baked
+    // for a different set of voxel types
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+    // The built in procedural textures, what VoxelEngine --bake-textures writes
+    static TextureAtlasData bake();
+};
+
+class TextureArray {
+public:
+    TextureArray();
+    ~TextureArray();
+
+    // Uploads the atlas with a full mip chain, baking it in memory if `path` won't load
+    void init(const std::string& path);
+    void bind(int unit) const;
+
+private:
+    GLuint texture;
+};
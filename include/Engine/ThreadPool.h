@@ -0,0 +1,36 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small pool of worker threads pulling jobs from a shared queue. Jobs must
+// not touch OpenGL, only the main thread owns the context.
+class ThreadPool {
+public:
+    // threadCount == 0 picks hardware_concurrency() - 1 (at least one worker)
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    void submit(std::function<void()> job);
+    // Starts or retires workers, same meaning of 0 as the constructor. Retired
+    // workers finish the job they are on first, which this waits for.
+    void setThreadCount(unsigned int threadCount);
+    // Drops queued jobs and joins the workers, jobs already running finish first
+    void shutdown();
+    size_t getThreadCount() const;
+    size_t getQueuedJobCount();
+
+private:
+    static unsigned int defaultThreadCount();
+    void workerLoop(size_t index);
+
+    std::vector<std::thread> workers;
+    size_t activeCount; // workers at an index at or past this exit
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+};
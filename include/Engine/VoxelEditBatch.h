@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include "Common.h"
+
+class Chunk;
+
+// Bulk voxel edits, applied in one go by InfiniteWorld::applyEdits. Edits are
+// applied in the order they were added, so a later edit to the same voxel wins.
+// Reusing one batch (clear() between uses) keeps it allocation free.
+class VoxelEditBatch {
+public:
+    void set(int worldX, int worldY, int worldZ, VoxelType type);
+    void set(const std::vector<glm::ivec3>& voxels, VoxelType type);
+    // Every voxel in [min, max], both corners included
+    void fillBox(const glm::ivec3& min, const glm::ivec3& max, VoxelType type);
+    // Every voxel whose center is within `radius` of `center`
+    void fillSphere(const vec3& center, float radius, VoxelType type);
+
+    void clear() { edits.clear(); }
+    size_t size() const { return edits.size(); }
+    bool empty() const { return edits.empty(); }
+
+private:
+    friend class InfiniteWorld;
+
+    struct Edit {
+        int x, y, z;
+        VoxelType type;
+    };
+    std::vector<Edit> edits;
+    // Sections changed by the last apply, one entry per section after dedup
+    std::vector<std::pair<Chunk*, int>> touchedSections;
+    // World positions of the voxels changed by the last apply, relit together
+    std::vector<glm::ivec3> changedVoxels;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "Common.h"
+
+// Voxel data of one chunk section. Uniform sections (all air, all stone) keep
+// a single VoxelType, anything else gets a dense one byte per voxel array
+// that is allocated on the first differing write. Dense arrays are recycled
+// through a shared free list, so streaming chunks in and out doesn't hit the heap.
+class VoxelStorage {
+public:
+    // Spare dense arrays kept around, 16 MiB at most
+    static constexpr size_t MAX_POOLED_BUFFERS = 4096;
+    static size_t getPooledBufferCount();
+
+    // SECTION_VOLUME bytes from the free list, LightStorage draws from it too
+    struct BufferReleaser {
+        void operator()(uint8_t* buffer) const;
+    };
+    using Buffer = std::unique_ptr<uint8_t[], BufferReleaser>;
+    static uint8_t* acquireBuffer();
+
+    // Section local coordinates, y varies slowest
+    static int indexOf(int x, int y, int z) {
+        return (y * CHUNK_SIZE + z) * CHUNK_SIZE + x;
+    }
+
+    VoxelType get(int x, int y, int z) const {
+        return data ? VoxelType(data[indexOf(x, y, z)]) : uniformType;
+    }
+    void set(int x, int y, int z, VoxelType type);
+    void fill(VoxelType type);
+    // Collapses back to a single value if every voxel matches, returns true if it did
+    bool compact();
+
+    bool isUniform() const { return !data; }
+    VoxelType getUniformType() const { return uniformType; }
+    const uint8_t* getData() const { return data.get(); }
+    size_t getMemoryUsage() const { return data ? SECTION_VOLUME : 0; }
+
+    // Run-length encoded form used on disk, readRLE advances `cursor` and
+    // returns false (leaving the storage untouched) on malformed input
+    void writeRLE(std::vector<uint8_t>& out) const;
+    bool readRLE(const uint8_t*& cursor, const uint8_t* end);
+
+private:
+    VoxelType uniformType = AIR;
+    Buffer data;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include "Common.h"
+
+// Streaming and quality knobs the settings panel changes while running, read
+// by InfiniteWorld every frame. The defaults are the constants in Common.h.
+// Chunk dimensions stay compile time, the packed vertex format is built on them.
+struct WorldSettings {
+    // Chunks loaded around the player, and how much further out they stay
+    // loaded so walking back and forth over a border doesn't reload them
+    int renderDistance = RENDER_DISTANCE;
+    int unloadMargin = 2;
+    // Generation and meshing threads, 0 picks hardware_concurrency() - 1
+    int workerThreads = 0;
+    // Per-frame mesh upload budget, see InfiniteWorld::uploadFinishedMeshes
+    int maxMeshUploadsPerFrame = MAX_MESH_UPLOADS_PER_FRAME;
+    size_t maxMeshUploadBytesPerFrame = MAX_MESH_UPLOAD_BYTES_PER_FRAME;
+    // Resident memory to stay under (see WorldMemoryStats), 0 for no cap.
+    // Chunks past the render distance are evicted least recently seen first.
+    size_t memoryBudget = size_t(1024) * 1024 * 1024;
+    // Compressed copies of unloaded chunks kept for walking back, also
+    // counted against memoryBudget. 0 turns retention off.
+    size_t retainedChunkBudget = size_t(64) * 1024 * 1024;
+
+    // Over targetFrameMs the LOD rings move in first, then the render distance
+    // drops (never below minRenderDistance). Both come back once there's headroom.
+    bool adaptiveQuality = false;
+    float targetFrameMs = 1000.0f / 60.0f;
+    int minRenderDistance = 4;
+};
+
+// Frames between two adaptive quality steps, lets streaming settle first
+constexpr int ADAPT_INTERVAL_FRAMES = 30;
+// LOD_BASE_DISTANCE is scaled down to this at most
+constexpr float MIN_LOD_DISTANCE_SCALE = 0.25f;
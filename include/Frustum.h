@@ -6,9 +6,16 @@
 class Frustum {
 public:
     enum Plane { Left = 0, Right, Bottom, Top, Near, Far, Count };
+    enum Result { Outside, Intersecting, Inside };
+    static constexpr unsigned ALL_PLANES = (1u << Plane::Count) - 1;
     
     void update(const glm::mat4& viewProj);
     bool isBoxVisible(const glm::vec3& min, const glm::vec3& max) const;
+    // Hierarchical test. planeMask holds the planes still worth testing, the
+    // ones the box is entirely inside of get cleared so children can skip them.
+    // planeHint is the plane that rejected this box last time, it's tried first
+    // and updated whenever another plane does the rejecting.
+    Result classifyBox(const glm::vec3& min, const glm::vec3& max, unsigned& planeMask, int& planeHint) const;
 
 private:
     std::array<glm::vec4, Plane::Count> planes;
@@ -1,4 +1,11 @@
 #pragma once
 #include "Common.h"
 
-Biome selectBiome(int worldX, int worldZ, int seed);
\ No newline at end of file
+const Biome& getBiome(int index);
+int getBiomeCount();
+// Startup only, the column cache keeps biome indices (see loadRegistry)
+void setBiomes(std::vector<Biome> list);
+
+// Looks the column up in the ColumnCache (sampled with GLOBAL_SEED), cheap
+// enough to call every frame
+const Biome& selectBiome(int worldX, int worldZ);
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include "Common.h"
+#include "Engine/ChunkMap.h"
+
+constexpr int COLUMN_REGION_CHUNKS = 4;
+constexpr int COLUMN_REGION_SIZE = COLUMN_REGION_CHUNKS * CHUNK_SIZE;
+// Smallest LRU size, InfiniteWorld grows it to cover everything it keeps loaded
+constexpr int COLUMN_CACHE_MAX_REGIONS = 256;
+
+// Everything generateTerrain needs to know about one column before it places voxels
+struct ColumnInfo {
+    uint8_t biome;
+    uint8_t height;
+    bool tree;
+};
+
+// Columns past the chunk border that getChunkColumns fills in too, so a chunk
+// can place the parts of trees rooted next door without that chunk existing
+constexpr int COLUMN_BORDER = 2;
+
+// The chunk's 16x16 columns and COLUMN_BORDER more on every side, indexed [z][x]
+struct ChunkColumns {
+    static constexpr int SIZE = CHUNK_SIZE + 2 * COLUMN_BORDER;
+    ColumnInfo columns[SIZE][SIZE];
+
+    // Chunk local, -COLUMN_BORDER to CHUNK_SIZE + COLUMN_BORDER - 1
+    const ColumnInfo& get(int x, int z) const { return columns[z + COLUMN_BORDER][x + COLUMN_BORDER]; }
+};
+
+// Biome, height and tree placement per world column, computed a 4x4 chunk
+// region at a time and kept in an LRU so chunks that get reloaded (and the
+// debug UI's biome lookup) don't run the noise again. Thread safe, regions are
+// filled outside the lock so workers only contend on the lookup itself.
+class ColumnCache {
+public:
+    static ColumnCache& get();
+
+    void getChunkColumns(ChunkCoord coord, ChunkColumns& out);
+    ColumnInfo getColumn(int worldX, int worldZ);
+    void clear();
+    // Drops the least recently used regions right away when shrinking
+    void setMaxRegions(size_t count);
+    // Regions a square of chunks `chunkDistance` around the player can touch,
+    // border columns included
+    static size_t regionsForDistance(int chunkDistance);
+
+    size_t getRegionCount();
+    size_t getMemoryUsage();
+
+private:
+    struct Region {
+        ChunkCoord coord;
+        unsigned int seed;
+        ColumnInfo columns[COLUMN_REGION_SIZE][COLUMN_REGION_SIZE];
+    };
+    using RegionList = std::list<Region>;
+
+    ColumnCache() = default;
+
+    static void fillRegion(Region& region);
+    // Expects the lock to be held, moves the region to the front of the LRU
+    const Region* findRegion(ChunkCoord regionCoord);
+    const Region& acquireRegion(std::unique_lock<std::mutex>& lock, ChunkCoord regionCoord);
+
+    std::mutex mutex;
+    RegionList regions; // most recently used first
+    size_t maxRegions = COLUMN_CACHE_MAX_REGIONS;
+    ChunkMap<RegionList::iterator> lookup;
+    unsigned int cacheSeed = 0;
+};
@@ -3,4 +3,23 @@
 float noise(int x, int z, int seed);
 float smoothNoise(float x, float z, int seed);
 float interpolatedNoise(float x, float z, int seed);
-float perlinNoise(float x, float z, int seed);
\ No newline at end of file
+float perlinNoise(float x, float z, int seed);
+
+// 2D simplex noise in [-1, 1], and the same octave sum as perlinNoise on top of it
+float simplexNoise(float x, float z, int seed);
+float fractalSimplexNoise(float x, float z, int seed);
+
+enum NoiseType {
+    NOISE_VALUE,   // perlinNoise, the original terrain look
+    NOISE_SIMPLEX  // fractalSimplexNoise, gradient based, no grid artifacts
+};
+
+// Noise used for terrain height and tree placement, biomes always use NOISE_VALUE
+const NoiseType TERRAIN_NOISE = NOISE_VALUE;
+
+// Fills out[z * width + x] with the fractal noise at
+// ((originX + x) * scale, (originZ + z) * scale). Lattice values are shared
+// between samples and the interpolation runs in SIMD lanes, NOISE_VALUE
+// results are bit-identical to calling perlinNoise per sample.
+void fractalNoiseBatch(NoiseType type, int originX, int originZ, int width, int depth,
+                       float scale, int seed, float* out);
@@ -0,0 +1,100 @@
+#include "Engine/BufferArena.h"
+#include <algorithm>
+
+// Enough for a fragmented arena of a full render distance without regrowing
+constexpr size_t RESERVED_FREE_BLOCKS = 4096;
+constexpr size_t RESERVED_BIN_BLOCKS = 512;
+
+BufferArena::BufferArena(uint32_t capacity) : capacity(capacity), used(0) {
+    freeBlocks.reserve(RESERVED_FREE_BLOCKS);
+    for (std::vector<Block>& bin : bins) bin.reserve(RESERVED_BIN_BLOCKS);
+    if (capacity > 0) {
+        addBlock({0, capacity});
+    }
+}
+
+int BufferArena::binOf(uint32_t size) {
+    int bin = 0;
+    while (size >>= 1) bin++;
+    return bin;
+}
+
+void BufferArena::addBlock(Block block) {
+    freeBlocks.insert(std::lower_bound(freeBlocks.begin(), freeBlocks.end(), block.offset, offsetLess), block);
+    std::vector<Block>& bin = bins[binOf(block.size)];
+    bin.insert(std::lower_bound(bin.begin(), bin.end(), block.offset, offsetLess), block);
+}
+
+void BufferArena::removeBlock(Block block) {
+    freeBlocks.erase(std::lower_bound(freeBlocks.begin(), freeBlocks.end(), block.offset, offsetLess));
+    std::vector<Block>& bin = bins[binOf(block.size)];
+    bin.erase(std::lower_bound(bin.begin(), bin.end(), block.offset, offsetLess));
+}
+
+bool BufferArena::allocate(uint32_t size, uint32_t& offset) {
+    if (size == 0) return false;
+
+    // Blocks in the size's own bin may be too small, any block in a bin above fits
+    int first = binOf(size);
+    const Block* best = nullptr;
+    for (const Block& block : bins[first]) {
+        if (block.size >= size) {
+            best = &block;
+            break;
+        }
+    }
+    for (int b = first + 1; b < BIN_COUNT; b++) {
+        if (!bins[b].empty() && (!best || bins[b].front().offset < best->offset)) best = &bins[b].front();
+    }
+    if (!best) return false;
+
+    Block block = *best;
+    removeBlock(block);
+    if (block.size > size) {
+        addBlock({block.offset + size, block.size - size});
+    }
+    offset = block.offset;
+    used += size;
+    return true;
+}
+
+void BufferArena::free(uint32_t offset, uint32_t size) {
+    if (size == 0) return;
+    used -= size;
+
+    Block merged = {offset, size};
+    auto next = std::lower_bound(freeBlocks.begin(), freeBlocks.end(), offset, offsetLess);
+    // Merge with the block right before and the one right after
+    bool mergePrev = next != freeBlocks.begin() && std::prev(next)->offset + std::prev(next)->size == offset;
+    bool mergeNext = next != freeBlocks.end() && offset + size == next->offset;
+    Block prevBlock = mergePrev ? *std::prev(next) : Block{};
+    Block nextBlock = mergeNext ? *next : Block{};
+    if (mergePrev) {
+        removeBlock(prevBlock);
+        merged.offset = prevBlock.offset;
+        merged.size += prevBlock.size;
+    }
+    if (mergeNext) {
+        removeBlock(nextBlock);
+        merged.size += nextBlock.size;
+    }
+    addBlock(merged);
+}
+
+void BufferArena::grow(uint32_t newCapacity) {
+    if (newCapacity <= capacity) return;
+    uint32_t oldCapacity = capacity;
+    capacity = newCapacity;
+    // free() would count this as released memory, so undo that
+    used += newCapacity - oldCapacity;
+    free(oldCapacity, newCapacity - oldCapacity);
+}
+
+uint32_t BufferArena::getLargestFreeBlock() const {
+    for (int b = BIN_COUNT - 1; b >= 0; b--) {
+        uint32_t largest = 0;
+        for (const Block& block : bins[b]) largest = std::max(largest, block.size);
+        if (largest > 0) return largest;
+    }
+    return 0;
+}
@@ -39,6 +39,12 @@ void Camera::processMouseMovement(float xoffset, float yoffset) {
     updateCameraVectors();
 }
 
+void Camera::setOrientation(float newYaw, float newPitch) {
+    yaw = newYaw;
+    pitch = glm::clamp(newPitch, -89.0f, 89.0f);
+    updateCameraVectors();
+}
+
 ChunkCoord Camera::getCurrentChunkCoord() const {
     int chunkX = (int)floor(position.x / CHUNK_SIZE);
     int chunkZ = (int)floor(position.z / CHUNK_SIZE);
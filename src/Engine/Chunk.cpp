@@ -1,81 +1,215 @@
 #include "Engine/Chunk.h"
 #include "Engine/InfiniteWorld.h"
-#include "Generation/Noise.h"
+#include "Engine/ChunkMesher.h"
+#include "Generation/Biomes.h"
+#include "Generation/ColumnCache.h"
 #include "Common.h"
-#include <GL/glew.h>
 
+// No GL calls here, chunks are constructed and generated on worker threads.
+// The mesh lives in the ChunkRenderer arena, see InfiniteWorld::uploadFinishedMeshes.
 Chunk::Chunk(ChunkCoord c, InfiniteWorld* w)
-    : coord(c), world(w), meshGenerated(false), meshDirty(true) {
+    : coord(c), world(w), neighbours{nullptr, nullptr, nullptr, nullptr} {
     worldPosition = vec3(coord.x * CHUNK_SIZE, 0, coord.z * CHUNK_SIZE);
-    generateTerrain();
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
 }
 
 Chunk::~Chunk() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
 }
 
+void Chunk::releaseSectionData() {
+    for (ChunkSection& section : sections) {
+        section.voxels.fill(AIR);
+        section.light.fill(0);
+        section.meshCache.reset();
+    }
+}
+
+void Chunk::reset(ChunkCoord c, InfiniteWorld* w) {
+    coord = c;
+    world = w;
+    for (Chunk*& neighbour : neighbours) neighbour = nullptr;
+    worldPosition = vec3(coord.x * CHUNK_SIZE, 0, coord.z * CHUNK_SIZE);
+    for (ChunkSection& section : sections) {
+        section.voxels.fill(AIR);
+        section.light.fill(0);
+        section.mesh = MeshAllocation();
+        section.translucentMesh = MeshAllocation();
+        section.translucentVertices.clear();
+        section.solidCount = 0;
+        section.translucentCount = 0;
+        section.markDirty();
+        section.meshJobId = 0;
+        section.meshCache.reset();
+        section.keepMeshCache = false;
+    }
+    needsSave = true;
+    cullPlaneHint = 0;
+    lod = 0;
+    lastSeenFrame = 0;
+}
+
+// Leaves reach TREE_RADIUS columns out from the trunk, the column cache has to cover that
+constexpr int TREE_TRUNK_HEIGHT = 4;
+constexpr int TREE_RADIUS = 2;
+static_assert(TREE_RADIUS <= COLUMN_BORDER, "trees reach further than the columns a chunk can see");
+
 void Chunk::generateTerrain() {
+    // Biome, height and tree noise come from the shared column cache
+    ChunkColumns columns;
+    ColumnCache::get().getChunkColumns(coord, columns);
 
-    // Define Biomes
-    Biome biomes[] = {
-        {"Plains", GRASS, DIRT, STONE, 20.0f, 4.0f},
-        {"Mountains", SNOW, GRASS, STONE, 32.0f, 18.0f},
-        {"Desert", SAND, SAND, STONE, 18.0f, 2.0f},
-        {"Forest", GRASS, DIRT, STONE, 22.0f, 5.0f}
+    auto placeVoxel = [this](int x, int y, int z, VoxelType type) {
+        sections[y / SECTION_SIZE].voxels.set(x, y % SECTION_SIZE, z, type);
     };
-    const int biomeCount = sizeof(biomes) / sizeof(Biome);
 
     for (int x = 0; x < CHUNK_SIZE; x++) {
         for (int z = 0; z < CHUNK_SIZE; z++) {
-            int worldX = coord.x * CHUNK_SIZE + x;
-            int worldZ = coord.z * CHUNK_SIZE + z;
-            
-            // Biome Selection
-            float biomeNoise = perlinNoise(worldX * 0.001f, worldZ * 0.001f, GLOBAL_SEED);
-            int biomeIndex = int((biomeNoise + 1.0f) * 0.5f * biomeCount) % biomeCount;
-            const Biome& biome = biomes[biomeIndex];
-
-            //Height Generation
-            float heightNoise = perlinNoise(worldX * 0.01f, worldZ * 0.01f, GLOBAL_SEED);
-            int height = int(biome.baseHeight + biome.heightVariation * heightNoise);
-            // Clamp height to valid range
-            height = std::max(1, std::min(CHUNK_HEIGHT - 1, height));
+            const ColumnInfo& column = columns.get(x, z);
+            const Biome& biome = getBiome(column.biome);
+            int height = column.height;
 
             for (int y = 0; y < CHUNK_HEIGHT; y++) {
                 if (y < height - 5) {
-                    voxels[x][y][z] = Voxel(biome.filler);
+                    placeVoxel(x, y, z, biome.filler);
                 } else if (y < height - 1) {
-                    voxels[x][y][z] = Voxel(biome.subsurface);
+                    placeVoxel(x, y, z, biome.subsurface);
                 } else if (y < height) {
-                    voxels[x][y][z] = Voxel(biome.surface);
-                } else if (y < 15 && biome.surface != SAND) {
-                    voxels[x][y][z] = Voxel(WATER);
+                    placeVoxel(x, y, z, biome.surface);
+                } else if (y < SEA_LEVEL && biome.water) {
+                    placeVoxel(x, y, z, WATER);
                 } else {
-                    voxels[x][y][z] = Voxel(AIR);
+                    break; // sections start out as air
                 }
             }
+        }
+    }
 
-            // Forest trees (simple, only in forest biome)
-            if (biome.name == "Mountains" || biome.name == "Forest" && height < CHUNK_HEIGHT - 6) {
-                float treeNoise = perlinNoise(worldX * 0.1f, worldZ * 0.1f, GLOBAL_SEED);
-                if (treeNoise > 0.6f) {
-                    // Place a simple tree
-                    for (int t = 0; t < 4; t++)
-                        voxels[x][height + t][z] = Voxel(LOG);
-                    for (int dx = -2; dx <= 2; dx++)
-                        for (int dz = -2; dz <= 2; dz++)
-                            for (int dy = 3; dy <= 5; dy++)
-                                if (x + dx >= 0 && x + dx < CHUNK_SIZE &&
-                                    z + dz >= 0 && z + dz < CHUNK_SIZE &&
-                                    abs(dx) + abs(dz) + (dy - 3) < 5)
-                                    voxels[x + dx][height + dy][z + dz] = Voxel(LEAVES);
-                }
+    // Decoration runs once all the terrain is down. Every chunk places the part
+    // of each nearby tree that falls inside it, trees rooted in the border
+    // columns included, so trees cross chunk borders without generation ever
+    // touching another chunk. Simple trees, in the biomes that grow them and
+    // with room above.
+    for (int z = -COLUMN_BORDER; z < CHUNK_SIZE + COLUMN_BORDER; z++) {
+        for (int x = -COLUMN_BORDER; x < CHUNK_SIZE + COLUMN_BORDER; x++) {
+            const ColumnInfo& column = columns.get(x, z);
+            if (column.tree && column.height < CHUNK_HEIGHT - 6 && getBiome(column.biome).trees) {
+                placeTree(x, column.height, z);
             }
         }
     }
+
+    compactSections();
+    recountSections();
+}
+
+// Tree standing on local column (x, z), which may be outside the chunk, clipped
+// to it. Logs replace anything and leaves only fill air, so overlapping trees
+// come out the same whichever order the chunks on either side place them in.
+void Chunk::placeTree(int x, int height, int z) {
+    auto inside = [](int localX, int localZ) {
+        return localX >= 0 && localX < CHUNK_SIZE && localZ >= 0 && localZ < CHUNK_SIZE;
+    };
+    if (inside(x, z)) {
+        for (int t = 0; t < TREE_TRUNK_HEIGHT; t++)
+            sections[(height + t) / SECTION_SIZE].voxels.set(x, (height + t) % SECTION_SIZE, z, LOG);
+    }
+    for (int dx = -TREE_RADIUS; dx <= TREE_RADIUS; dx++) {
+        for (int dz = -TREE_RADIUS; dz <= TREE_RADIUS; dz++) {
+            if (!inside(x + dx, z + dz)) continue;
+            for (int dy = 3; dy <= 5; dy++) {
+                int y = height + dy;
+                VoxelStorage& voxels = sections[y / SECTION_SIZE].voxels;
+                if (abs(dx) + abs(dz) + (dy - 3) < 5 && voxels.get(x + dx, y % SECTION_SIZE, z + dz) == AIR)
+                    voxels.set(x + dx, y % SECTION_SIZE, z + dz, LEAVES);
+            }
+        }
+    }
+}
+
+// Floodfill volume over a single chunk in local coordinates, see Lighting.h
+class ChunkLightVolume {
+public:
+    explicit ChunkLightVolume(Chunk& chunk) : chunk(chunk) {}
+
+    bool contains(int x, int y, int z) const {
+        return x >= 0 && x < CHUNK_SIZE && y >= 0 && y < CHUNK_HEIGHT && z >= 0 && z < CHUNK_SIZE;
+    }
+    bool isTransparent(int x, int y, int z) const {
+        return contains(x, y, z) && !isOpaqueVoxel(chunk.getVoxel(x, y, z));
+    }
+    int getLight(int x, int y, int z, LightChannel channel) const {
+        return getLightLevel(chunk.getLight(x, y, z), channel);
+    }
+    void setLight(int x, int y, int z, LightChannel channel, int level) {
+        chunk.setLight(x, y, z, setLightLevel(chunk.getLight(x, y, z), channel, level));
+    }
+    int getEmission(int x, int y, int z) const {
+        return getVoxelEmission(chunk.getVoxel(x, y, z));
+    }
+
+private:
+    Chunk& chunk;
+};
+
+// Worker thread. Sunlight falls straight down every column until the first
+// opaque voxel, then floods sideways under overhangs and trees. Only voxels
+// next to a column that is dark further up can spread anything, so only those
+// seed the floodfill.
+void Chunk::computeLight() {
+    thread_local LightQueues queues;
+    ChunkLightVolume volume(*this);
+
+    int skyBottom[CHUNK_SIZE][CHUNK_SIZE]; // [z][x], lowest voxel the sun reaches
+    int highestSkyBottom = 0;
+    for (int z = 0; z < CHUNK_SIZE; z++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            int y = CHUNK_HEIGHT;
+            while (y > 0 && !isOpaqueVoxel(getVoxel(x, y - 1, z))) y--;
+            skyBottom[z][x] = y;
+            highestSkyBottom = std::max(highestSkyBottom, y);
+        }
+    }
+
+    // Sections the sun reaches all the way through stay uniform
+    int litFrom = (highestSkyBottom + SECTION_SIZE - 1) / SECTION_SIZE * SECTION_SIZE;
+    for (int s = 0; s < SECTIONS_PER_CHUNK; s++) {
+        sections[s].light.fill(s * SECTION_SIZE >= litFrom ? FULL_SKY_LIGHT : 0);
+    }
+    for (int z = 0; z < CHUNK_SIZE; z++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int y = skyBottom[z][x]; y < litFrom; y++) setLight(x, y, z, FULL_SKY_LIGHT);
+        }
+    }
+
+    for (int z = 0; z < CHUNK_SIZE; z++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            int darkAbove = skyBottom[z][x];
+            if (x > 0) darkAbove = std::max(darkAbove, skyBottom[z][x - 1]);
+            if (x + 1 < CHUNK_SIZE) darkAbove = std::max(darkAbove, skyBottom[z][x + 1]);
+            if (z > 0) darkAbove = std::max(darkAbove, skyBottom[z - 1][x]);
+            if (z + 1 < CHUNK_SIZE) darkAbove = std::max(darkAbove, skyBottom[z + 1][x]);
+            for (int y = skyBottom[z][x]; y < darkAbove; y++) queues.add.push_back({x, y, z, 0});
+        }
+    }
+    propagateLight(volume, LIGHT_SKY, queues);
+
+    for (int s = 0; s < SECTIONS_PER_CHUNK; s++) {
+        const uint8_t* data = sections[s].voxels.getData();
+        if (!data) continue; // no uniform section is made of emitters
+        for (int i = 0; i < SECTION_VOLUME; i++) {
+            int emission = getVoxelEmission(VoxelType(data[i]));
+            if (emission == 0) continue;
+            int x = i % CHUNK_SIZE;
+            int z = (i / CHUNK_SIZE) % CHUNK_SIZE;
+            int y = s * SECTION_SIZE + i / (CHUNK_SIZE * CHUNK_SIZE);
+            volume.setLight(x, y, z, LIGHT_BLOCK, emission);
+            queues.add.push_back({x, y, z, 0});
+        }
+    }
+    propagateLight(volume, LIGHT_BLOCK, queues);
+
+    for (ChunkSection& section : sections) {
+        section.light.compact();
+    }
 }
 
 bool Chunk::isVoxelSolidAtPosition(int x, int y, int z) {
@@ -86,291 +220,165 @@ bool Chunk::isVoxelSolidAtPosition(int x, int y, int z) {
 }
 
 vec3 Chunk::getVoxelColor(VoxelType type) {
-    switch (type) {
-        case STONE:     return vec3(0.5f, 0.5f, 0.5f);
-        case GRASS:     return vec3(0.0f, 0.8f, 0.0f);
-        case DIRT:      return vec3(0.6f, 0.4f, 0.2f);
-        case SAND:      return vec3(0.9f, 0.8f, 0.5f);
-        case WATER:     return vec3(0.2f, 0.4f, 0.8f);
-        case SNOW:      return vec3(0.95f, 0.98f, 1.0f);
-        case LOG:       return vec3(0.55f, 0.27f, 0.07f);
-        case LEAVES:    return vec3(0.13f, 0.55f, 0.13f);
-        default:        return vec3(1.0f, 1.0f, 1.0f);
-    }
+    return BLOCK_TABLE.color[type];
 }
 
-void Chunk::addFace(int x, int y, int z, int face, vec3 color) {
-    float vx = x + worldPosition.x;
-    float vy = y + worldPosition.y;
-    float vz = z + worldPosition.z;
-    
-    float faceVertices[6][4][9] = {
-        // Front face (Z+)
-        {{vx,vy,vz+1,0,0,1,color.r,color.g,color.b},{vx+1,vy,vz+1,0,0,1,color.r,color.g,color.b},
-         {vx+1,vy+1,vz+1,0,0,1,color.r,color.g,color.b},{vx,vy+1,vz+1,0,0,1,color.r,color.g,color.b}},
-        // Back face (Z-)
-        {{vx+1,vy,vz,0,0,-1,color.r,color.g,color.b},{vx,vy,vz,0,0,-1,color.r,color.g,color.b},
-         {vx,vy+1,vz,0,0,-1,color.r,color.g,color.b},{vx+1,vy+1,vz,0,0,-1,color.r,color.g,color.b}},
-        // Left face (X-)
-        {{vx,vy,vz,-1,0,0,color.r,color.g,color.b},{vx,vy,vz+1,-1,0,0,color.r,color.g,color.b},
-         {vx,vy+1,vz+1,-1,0,0,color.r,color.g,color.b},{vx,vy+1,vz,-1,0,0,color.r,color.g,color.b}},
-        // Right face (X+)
-        {{vx+1,vy,vz+1,1,0,0,color.r,color.g,color.b},{vx+1,vy,vz,1,0,0,color.r,color.g,color.b},
-         {vx+1,vy+1,vz,1,0,0,color.r,color.g,color.b},{vx+1,vy+1,vz+1,1,0,0,color.r,color.g,color.b}},
-        // Bottom face (Y-)
-        {{vx,vy,vz,0,-1,0,color.r,color.g,color.b},{vx+1,vy,vz,0,-1,0,color.r,color.g,color.b},
-         {vx+1,vy,vz+1,0,-1,0,color.r,color.g,color.b},{vx,vy,vz+1,0,-1,0,color.r,color.g,color.b}},
-        // Top face (Y+)
-        {{vx,vy+1,vz+1,0,1,0,color.r,color.g,color.b},{vx+1,vy+1,vz+1,0,1,0,color.r,color.g,color.b},
-         {vx+1,vy+1,vz,0,1,0,color.r,color.g,color.b},{vx,vy+1,vz,0,1,0,color.r,color.g,color.b}}
-    };
-    
-    int indices[] = {0,1,2,0,2,3};
-    for (int i = 0; i < 6; i++) {
-        int vertIndex = indices[i];
-        for (int j = 0; j < 9; j++) {
-            vertices.push_back(faceVertices[face][vertIndex][j]);
-        }
-    }
+// Coordinates outside the chunk hop through the neighbour pointers, so border
+// lookups never touch the world's chunk map. Unloaded neighbours read as AIR.
+VoxelType Chunk::getVoxelTypeAt(int x, int y, int z) {
+    // If out of world bounds (e.g., below 0 or above world height), treat as AIR
+    if (y < 0 || y >= CHUNK_HEIGHT)
+        return AIR;
+
+    Chunk* chunk = this;
+    while (x < 0 && chunk) { chunk = chunk->neighbours[NEIGHBOUR_NEG_X]; x += CHUNK_SIZE; }
+    while (x >= CHUNK_SIZE && chunk) { chunk = chunk->neighbours[NEIGHBOUR_POS_X]; x -= CHUNK_SIZE; }
+    while (z < 0 && chunk) { chunk = chunk->neighbours[NEIGHBOUR_NEG_Z]; z += CHUNK_SIZE; }
+    while (z >= CHUNK_SIZE && chunk) { chunk = chunk->neighbours[NEIGHBOUR_POS_Z]; z -= CHUNK_SIZE; }
+    if (!chunk)
+        return AIR;
+
+    return chunk->getVoxel(x, y, z);
 }
 
-void Chunk::generateMesh() {
-    vertices.clear();
-    
-    // Generate mesh for each of the 6 face directions
-    generateFacesForDirection(0, 1);   // +X faces
-    generateFacesForDirection(0, -1);  // -X faces
-    generateFacesForDirection(1, 1);   // +Y faces
-    generateFacesForDirection(1, -1);  // -Y faces
-    generateFacesForDirection(2, 1);   // +Z faces
-    generateFacesForDirection(2, -1);  // -Z faces
-    
-    // Upload vertices to GPU
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), 
-                 vertices.empty() ? nullptr : &vertices[0], GL_STATIC_DRAW);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    
-    glBindVertexArray(0);
-    meshGenerated = true;
-    meshDirty = false;
+uint8_t Chunk::getLightAt(int x, int y, int z) {
+    if (y >= CHUNK_HEIGHT) return FULL_SKY_LIGHT;
+    if (y < 0) return 0;
+
+    Chunk* chunk = this;
+    while (x < 0 && chunk) { chunk = chunk->neighbours[NEIGHBOUR_NEG_X]; x += CHUNK_SIZE; }
+    while (x >= CHUNK_SIZE && chunk) { chunk = chunk->neighbours[NEIGHBOUR_POS_X]; x -= CHUNK_SIZE; }
+    while (z < 0 && chunk) { chunk = chunk->neighbours[NEIGHBOUR_NEG_Z]; z += CHUNK_SIZE; }
+    while (z >= CHUNK_SIZE && chunk) { chunk = chunk->neighbours[NEIGHBOUR_POS_Z]; z -= CHUNK_SIZE; }
+    if (!chunk) return FULL_SKY_LIGHT;
+
+    return chunk->getLight(x, y, z);
 }
 
-void Chunk::generateFacesForDirection(int axis, int direction) {
-    // Define dimensions based on axis
-    int dimensions[3] = {CHUNK_SIZE, CHUNK_HEIGHT, CHUNK_SIZE};
-    
-    // Create coordinate mapping
-    int u, v, w;
-    if (axis == 0) { // X axis
-        u = 1; v = 2; w = 0; // u=Y, v=Z, w=X
-    } else if (axis == 1) { // Y axis
-        u = 0; v = 2; w = 1; // u=X, v=Z, w=Y
-    } else { // Z axis
-        u = 0; v = 1; w = 2; // u=X, v=Y, w=Z
+// Main thread only, the border is read through the neighbour pointers.
+// A downsampled chunk next to one at another level reads that side as air, so
+// it closes the seam with a wall of border faces instead of leaving cracks.
+void Chunk::takeSnapshot(int sectionIndex, SectionSnapshot& snapshot) {
+    snapshot.coord = coord;
+    snapshot.sectionIndex = sectionIndex;
+    snapshot.lod = lod;
+    for (uint32_t& slices : snapshot.dirtySlices) slices = ALL_SLICES;
+    snapshot.keepCache = false;
+    bool seam[4];
+    for (int i = 0; i < 4; i++) {
+        seam[i] = lod > 0 && neighbours[i] && neighbours[i]->lod != lod;
     }
-    
-    // Iterate through each slice perpendicular to the axis
-    for (int d = 0; d < dimensions[axis]; d++) {
-        // Create mask for this slice
-        VoxelType mask[CHUNK_SIZE * CHUNK_HEIGHT];
-        std::fill_n(mask, CHUNK_SIZE * CHUNK_HEIGHT, AIR);
-        
-        // Fill mask - check if face should be rendered
-        for (int j = 0; j < dimensions[v]; j++) {
-    for (int i = 0; i < dimensions[u]; i++) {
-        int pos[3];
-        pos[u] = i;
-        pos[v] = j;
-        pos[w] = d;
-
-        int adjPos[3];
-        adjPos[u] = i;
-        adjPos[v] = j;
-        adjPos[w] = d + direction;
-
-        VoxelType current = getVoxelTypeAt(pos[0], pos[1], pos[2]);
-        VoxelType adjacent = getVoxelTypeAt(adjPos[0], adjPos[1], adjPos[2]);
-
-        // Only create face if current is solid and adjacent is NOT solid (air or water)
-        bool currentSolid = (current != AIR && current != WATER);
-        bool adjacentSolid = (adjacent != AIR && adjacent != WATER);
-
-        if (axis == 1 && direction == -1 && pos[1] == 0) {
-        mask[j * dimensions[u] + i] = AIR;
-        continue;
-        }
 
-        if (currentSolid && !adjacentSolid) {
-            mask[j * dimensions[u] + i] = current;
-        } else {
-            mask[j * dimensions[u] + i] = AIR;
-        }
-    }
-}
-        // Process mask to find quads
-        // Iterate through mask to find contiguous areas of the same voxel type
-        // This will allow us to create larger quads instead of individual faces
-        for (int j = 0; j < dimensions[v]; j++) {
-            for (int i = 0; i < dimensions[u]; ) {
-                if (mask[j * dimensions[u] + i] != AIR) {
-                    VoxelType voxelType = mask[j * dimensions[u] + i];
-                    
-                    // Find width of quad
-                    int width = 1;
-                    for (int k = i + 1; k < dimensions[u]; k++) {
-                        if (mask[j * dimensions[u] + k] == voxelType) {
-                            width++;
-                        } else {
-                            break;
-                        }
-                    }
-                    
-                    // Find height of quad
-                    int height = 1;
-                    bool canExtend = true;
-                    for (int k = j + 1; k < dimensions[v] && canExtend; k++) {
-                        for (int l = i; l < i + width; l++) {
-                            if (mask[k * dimensions[u] + l] != voxelType) {
-                                canExtend = false;
-                                break;
-                            }
-                        }
-                        if (canExtend) {
-                            height++;
-                        }
-                    }
-                    
-                    // Create the quad
-                    addOptimizedQuad(axis, direction, i, j, d, width, height, u, v, w, voxelType);
-                    
-                    // Clear processed area from mask
-                    for (int dv = 0; dv < height; dv++) {
-                        for (int du = 0; du < width; du++) {
-                            mask[(j + dv) * dimensions[u] + (i + du)] = AIR;
-                        }
-                    }
-                    
-                    i += width;
+    int baseY = sectionIndex * SECTION_SIZE;
+    const VoxelStorage& storage = sections[sectionIndex].voxels;
+    const LightStorage& light = sections[sectionIndex].light;
+    for (int x = -1; x <= CHUNK_SIZE; x++) {
+        for (int y = -1; y <= SECTION_SIZE; y++) {
+            for (int z = -1; z <= CHUNK_SIZE; z++) {
+                bool interior = x >= 0 && x < CHUNK_SIZE && y >= 0 && y < SECTION_SIZE && z >= 0 && z < CHUNK_SIZE;
+                if (interior) {
+                    snapshot.set(x, y, z, storage.get(x, y, z));
+                    snapshot.setLight(x, y, z, light.get(x, y, z));
+                } else if ((x < 0 && seam[NEIGHBOUR_NEG_X]) || (x >= CHUNK_SIZE && seam[NEIGHBOUR_POS_X]) ||
+                           (z < 0 && seam[NEIGHBOUR_NEG_Z]) || (z >= CHUNK_SIZE && seam[NEIGHBOUR_POS_Z])) {
+                    snapshot.set(x, y, z, AIR);
+                    snapshot.setLight(x, y, z, FULL_SKY_LIGHT);
                 } else {
-                    i++;
+                    snapshot.set(x, y, z, getVoxelTypeAt(x, baseY + y, z));
+                    snapshot.setLight(x, y, z, getLightAt(x, baseY + y, z));
                 }
             }
         }
     }
 }
 
-void Chunk::addOptimizedQuad(int axis, int direction, int i, int j, int d, 
-                            int width, int height, int u, int v, int w, VoxelType voxelType) {
-    // Assign different colors for each face
-    vec3 color;
-    if (axis == 1 && direction == 1) { // Top face (Y+)
-        color = getVoxelColor(voxelType) * vec3(1.0f, 1.0f, 1.0f); // Brighter
-    } else if (axis == 1 && direction == -1) { // Bottom face (Y-)
-        color = getVoxelColor(voxelType) * vec3(0.7f, 0.7f, 0.7f); // Darker
-    } else { // Sides (X/Z)
-        color = getVoxelColor(voxelType) * vec3(0.85f, 0.85f, 0.85f); // Slightly dim
-    }
+void Chunk::setVoxel(int x, int y, int z, VoxelType type) {
+    ChunkSection& section = sections[y / SECTION_SIZE];
+    int sectionY = y % SECTION_SIZE;
+    VoxelType old = section.voxels.get(x, sectionY, z);
+    if (occludesFaces(old)) section.solidCount--;
+    if (isTranslucentVoxel(old)) section.translucentCount--;
+    if (occludesFaces(type)) section.solidCount++;
+    if (isTranslucentVoxel(type)) section.translucentCount++;
+    section.voxels.set(x, sectionY, z, type);
+}
 
-    // ...existing code for quad generation...
-    // Base position
-    int pos[3] = {0, 0, 0};
-    pos[u] = i;
-    pos[v] = j;
-    pos[w] = d;
-
-    // Offsets for quad corners
-    int du[3] = {0, 0, 0};
-    int dv[3] = {0, 0, 0};
-    du[u] = width;
-    dv[v] = height;
-
-    // Offset for face direction
-    float faceOffset = (direction > 0) ? 1.0f : 0.0f;
-
-    // Four corners (explicitly for each face)
-    vec3 corners[4];
-    for (int c = 0; c < 4; ++c) {
-        int corner[3] = { pos[0], pos[1], pos[2] };
-        if (c == 1 || c == 2) corner[u] += du[u];
-        if (c == 2 || c == 3) corner[v] += dv[v];
-        corner[w] += faceOffset;
-        corners[c] = vec3(
-            corner[0] + worldPosition.x,
-            corner[1] + worldPosition.y,
-            corner[2] + worldPosition.z
-        );
+void Chunk::recountSections() {
+    for (ChunkSection& section : sections) {
+        const uint8_t* data = section.voxels.getData();
+        if (!data) {
+            VoxelType type = section.voxels.getUniformType();
+            section.solidCount = occludesFaces(type) ? SECTION_VOLUME : 0;
+            section.translucentCount = isTranslucentVoxel(type) ? SECTION_VOLUME : 0;
+            continue;
+        }
+        int solidCount = 0;
+        int translucentCount = 0;
+        for (int i = 0; i < SECTION_VOLUME; i++) {
+            if (occludesFaces(VoxelType(data[i]))) solidCount++;
+            if (isTranslucentVoxel(VoxelType(data[i]))) translucentCount++;
+        }
+        section.solidCount = solidCount;
+        section.translucentCount = translucentCount;
     }
+}
 
-    // Normal
-    vec3 normal(0, 0, 0);
-    normal[axis] = direction;
+void Chunk::compactSections() {
+    for (ChunkSection& section : sections) {
+        section.voxels.compact();
+    }
+}
 
-    // Winding order: flip for negative direction
-    int quad[4] = {0, 1, 2, 3};
-    if (direction < 0)
-        std::swap(quad[1], quad[3]);
+size_t Chunk::getMemoryUsage() const {
+    return getVoxelMemoryUsage() + getMeshMemoryUsage();
+}
 
-    // Special case for top face (Y+): ensure correct winding
-    if (axis == 1 && direction == 1) {
-        std::swap(quad[1], quad[3]);
+size_t Chunk::getVoxelMemoryUsage() const {
+    size_t bytes = sizeof(Chunk);
+    for (const ChunkSection& section : sections) {
+        bytes += section.voxels.getMemoryUsage() + section.light.getMemoryUsage();
     }
+    return bytes;
+}
 
-    // Two triangles
-    int triangles[2][3] = { {quad[0], quad[1], quad[2]}, {quad[0], quad[2], quad[3]} };
-    for (int t = 0; t < 2; t++) {
-        for (int vtx = 0; vtx < 3; vtx++) {
-            vec3 vertex = corners[triangles[t][vtx]];
-            // Position
-            vertices.push_back(vertex.x);
-            vertices.push_back(vertex.y);
-            vertices.push_back(vertex.z);
-            // Normal
-            vertices.push_back(normal.x);
-            vertices.push_back(normal.y);
-            vertices.push_back(normal.z);
-            // Color
-            vertices.push_back(color.r);
-            vertices.push_back(color.g);
-            vertices.push_back(color.b);
-        }
+size_t Chunk::getMeshMemoryUsage() const {
+    size_t bytes = 0;
+    for (const ChunkSection& section : sections) {
+        if (section.meshCache) bytes += section.meshCache->vertices.capacity() * sizeof(ChunkVertex);
+        bytes += section.translucentVertices.capacity() * sizeof(ChunkVertex);
     }
+    return bytes;
 }
 
-VoxelType Chunk::getVoxelTypeAt(int x, int y, int z) {
-    // Handle bounds checking
-    if (x < 0 || x >= CHUNK_SIZE || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_SIZE) {
-        // Query adjacent chunks through world
-        int worldX = coord.x * CHUNK_SIZE + x;
-        int worldY = y;
-        int worldZ = coord.z * CHUNK_SIZE + z;
-
-        // If out of world bounds (e.g., below 0 or above world height), treat as AIR
-        if (worldY < 0 || worldY >= CHUNK_HEIGHT)
-            return AIR;
-
-        return world->getVoxelTypeAt(worldX, worldY, worldZ);
-    }
+constexpr uint8_t CHUNK_FORMAT_VERSION = 1;
 
-    return voxels[x][y][z].isActive ? voxels[x][y][z].type : AIR;
+void Chunk::serialize(std::vector<uint8_t>& out) const {
+    out.push_back(CHUNK_FORMAT_VERSION);
+    for (const ChunkSection& section : sections) {
+        section.voxels.writeRLE(out);
+    }
 }
 
+// Decodes into scratch storage first so a bad payload leaves the chunk untouched
+bool Chunk::deserialize(const std::vector<uint8_t>& payload) {
+    if (payload.empty() || payload[0] != CHUNK_FORMAT_VERSION) return false;
 
-void Chunk::render() {
-    if (!meshGenerated || meshDirty) {
-        generateMesh();
+    VoxelStorage decoded[SECTIONS_PER_CHUNK];
+    const uint8_t* cursor = payload.data() + 1;
+    const uint8_t* end = payload.data() + payload.size();
+    for (VoxelStorage& storage : decoded) {
+        if (!storage.readRLE(cursor, end)) return false;
     }
-    
-    if (!vertices.empty()) {
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, vertices.size() / 9);
-        glBindVertexArray(0);
+    for (int s = 0; s < SECTIONS_PER_CHUNK; s++) {
+        sections[s].voxels = std::move(decoded[s]);
     }
-}
\ No newline at end of file
+    recountSections();
+    needsSave = false;
+    return true;
+}
+
+void Chunk::markAllSectionsDirty() {
+    for (ChunkSection& section : sections) {
+        section.markDirty();
+    }
+}
@@ -0,0 +1,351 @@
+#include "Engine/ChunkMesher.h"
+#include <algorithm>
+#include <cstring>
+#include "Common.h"
+
+ChunkMesher::ChunkMesher(const SectionSnapshot& snapshot, std::vector<ChunkVertex>& vertices,
+                         std::vector<ChunkVertex>& translucentVertices)
+    : snapshot(snapshot), vertices(vertices), translucentVertices(translucentVertices), previous(nullptr) {}
+
+constexpr int MAX_DIMENSION = MAX_SECTION_SLICES;
+
+static inline int countTrailingZeros(uint32_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return int(index);
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+// Axis mapping shared by every pass: u/v span the face plane, w is the normal axis
+static void axisMapping(int axis, int& u, int& v, int& w) {
+    if (axis == 0) { // X axis
+        u = 1; v = 2; w = 0; // u=Y, v=Z, w=X
+    } else if (axis == 1) { // Y axis
+        u = 0; v = 2; w = 1; // u=X, v=Z, w=Y
+    } else { // Z axis
+        u = 0; v = 1; w = 2; // u=X, v=Y, w=Z
+    }
+}
+
+// Highest solid voxel in the padded box [x0,x1] x [y0,y1] x [z0,z1], WATER
+// if there is none but some water, AIR otherwise
+static uint8_t topSolidVoxel(const uint8_t (&voxels)[SectionSnapshot::PADDED_X][SectionSnapshot::PADDED_Y][SectionSnapshot::PADDED_Z],
+                             int x0, int x1, int y0, int y1, int z0, int z1) {
+    uint8_t fallback = AIR;
+    for (int y = y1; y >= y0; y--)
+        for (int x = x0; x <= x1; x++)
+            for (int z = z0; z <= z1; z++) {
+                if (isSolidVoxel(VoxelType(voxels[x][y][z]))) return voxels[x][y][z];
+                if (voxels[x][y][z] == WATER) fallback = WATER;
+            }
+    return fallback;
+}
+
+void downsampleSnapshot(SectionSnapshot& snapshot) {
+    int lod = snapshot.lod;
+    if (lod == 0) return;
+    int scale = 1 << lod;
+
+    uint8_t fine[SectionSnapshot::PADDED_X][SectionSnapshot::PADDED_Y][SectionSnapshot::PADDED_Z];
+    std::memcpy(fine, snapshot.voxels, sizeof(fine));
+
+    // Padded fine voxels covered by padded cell c, the border cells map to the border layer
+    int dimensions[3] = {CHUNK_SIZE, SECTION_SIZE, CHUNK_SIZE};
+    auto cellRange = [&](int axis, int c, int& first, int& last) {
+        int cells = dimensions[axis] >> lod;
+        if (c == 0) {
+            first = last = 0;
+        } else if (c > cells) {
+            first = last = dimensions[axis] + 1;
+        } else {
+            first = (c - 1) * scale + 1;
+            last = first + scale - 1;
+        }
+    };
+
+    for (int cx = 0; cx < (CHUNK_SIZE >> lod) + 2; cx++) {
+        int x0, x1;
+        cellRange(0, cx, x0, x1);
+        for (int cy = 0; cy < (SECTION_SIZE >> lod) + 2; cy++) {
+            int y0, y1;
+            cellRange(1, cy, y0, y1);
+            for (int cz = 0; cz < (CHUNK_SIZE >> lod) + 2; cz++) {
+                int z0, z1;
+                cellRange(2, cz, z0, z1);
+                snapshot.voxels[cx][cy][cz] = topSolidVoxel(fine, x0, x1, y0, y1, z0, z1);
+            }
+        }
+    }
+}
+
+void ChunkMesher::generateMesh(const SectionMeshCache* previousMesh) {
+    previous = previousMesh;
+    vertices.clear();
+    translucentVertices.clear();
+    bool anyTranslucent = buildColumns();
+
+    // Generate mesh for each of the 6 face directions
+    for (bool translucent : {false, true}) {
+        if (translucent && !anyTranslucent) break;
+        generateFacesForDirection(0, 1, translucent);   // +X faces
+        generateFacesForDirection(0, -1, translucent);  // -X faces
+        generateFacesForDirection(1, 1, translucent);   // +Y faces
+        generateFacesForDirection(1, -1, translucent);  // -Y faces
+        generateFacesForDirection(2, 1, translucent);   // +Z faces
+        generateFacesForDirection(2, -1, translucent);  // -Z faces
+    }
+}
+
+void ChunkMesher::copySliceStarts(SectionMeshCache& cache) const {
+    std::copy(&sliceStart[0][0], &sliceStart[0][0] + 6 * (MAX_SECTION_SLICES + 1), &cache.sliceStart[0][0]);
+}
+
+// One pass over the padded snapshot fills the occupancy columns for all three
+// axes, returns whether the section itself (not just its border) has any
+// translucent voxel
+bool ChunkMesher::buildColumns() {
+    std::fill_n(&columns[0][0][0], 3 * 32 * 32, 0u);
+    std::fill_n(&translucentColumns[0][0][0], 3 * 32 * 32, 0u);
+    bool anyTranslucent = false;
+    // Downsampled snapshots only fill the start of the padded array
+    int lod = snapshot.lod;
+    int sizeX = (CHUNK_SIZE >> lod) + 2;
+    int sizeY = (SECTION_SIZE >> lod) + 2;
+    int sizeZ = (CHUNK_SIZE >> lod) + 2;
+    for (int x = 0; x < sizeX; x++) {
+        for (int y = 0; y < sizeY; y++) {
+            for (int z = 0; z < sizeZ; z++) {
+                VoxelType type = VoxelType(snapshot.voxels[x][y][z]);
+                uint32_t (*target)[32][32];
+                if (occludesFaces(type)) {
+                    target = columns;
+                } else if (isTranslucentVoxel(type)) {
+                    target = translucentColumns;
+                    anyTranslucent |= x > 0 && x < sizeX - 1 && y > 0 && y < sizeY - 1 && z > 0 && z < sizeZ - 1;
+                } else {
+                    continue;
+                }
+                target[0][z][y] |= 1u << x;
+                target[1][z][x] |= 1u << y;
+                target[2][y][x] |= 1u << z;
+            }
+        }
+    }
+    return anyTranslucent;
+}
+
+void ChunkMesher::generateFacesForDirection(int axis, int direction, bool translucent) {
+    int lod = snapshot.lod;
+    int dimensions[3] = {CHUNK_SIZE >> lod, SECTION_SIZE >> lod, CHUNK_SIZE >> lod};
+    int u, v, w;
+    axisMapping(axis, u, v, w);
+    uint32_t sliceMask = (1u << dimensions[w]) - 1;
+    // Clean slices come from the previous mesh, which only holds opaque faces
+    uint32_t rebuildSlices = previous && !translucent ? snapshot.dirtySlices[w] & sliceMask : sliceMask;
+    std::vector<ChunkVertex>& out = translucent ? translucentVertices : vertices;
+    int normal = normalIndex(axis, direction);
+
+    // rows[d][type][j] has bit i set for every visible face of that type in slice d
+    uint32_t rows[MAX_DIMENSION][VOXEL_TYPE_COUNT][MAX_DIMENSION] = {};
+    uint32_t typesInSlice[MAX_DIMENSION] = {};
+    // faceKeys[d][j][i], lighting of each face set in rows (see faceLighting)
+    uint16_t faceKeys[MAX_DIMENSION][MAX_DIMENSION][MAX_DIMENSION];
+
+    for (int j = 0; j < dimensions[v]; j++) {
+        for (int i = 0; i < dimensions[u]; i++) {
+            // Present here and nothing hiding the face one step along the normal.
+            // Translucent faces are hidden by anything solid, water by water too.
+            uint32_t column = columns[axis][j + 1][i + 1];
+            uint32_t blockers = column;
+            if (translucent) {
+                column = translucentColumns[axis][j + 1][i + 1];
+                blockers |= column;
+            }
+            uint32_t faces = direction > 0 ? column & ~(blockers >> 1) : column & ~(blockers << 1);
+            // Drop the padding bits, bit d is now slice d
+            faces = (faces >> 1) & rebuildSlices;
+
+            // Never draw the underside of the world
+            if (axis == 1 && direction == -1 && snapshot.sectionIndex == 0) {
+                faces &= ~1u;
+            }
+
+            while (faces) {
+                int d = countTrailingZeros(faces);
+                faces &= faces - 1;
+
+                int pos[3];
+                pos[u] = i;
+                pos[v] = j;
+                pos[w] = d;
+                VoxelType type = snapshot.get(pos[0], pos[1], pos[2]);
+                rows[d][type][j] |= 1u << i;
+                typesInSlice[d] |= 1u << type;
+                faceKeys[d][j][i] = faceLighting(pos, direction, u, v, w);
+            }
+        }
+    }
+
+    // Greedy merge: grow each run of equally lit faces along u, then extend it
+    // along v while the rows below contain the same run with the same lighting
+    for (int d = 0; d < dimensions[w]; d++) {
+        if (!translucent) sliceStart[normal][d] = uint32_t(vertices.size());
+        if (!(rebuildSlices & (1u << d))) {
+            const ChunkVertex* first = previous->vertices.data() + previous->sliceStart[normal][d];
+            const ChunkVertex* last = previous->vertices.data() + previous->sliceStart[normal][d + 1];
+            vertices.insert(vertices.end(), first, last);
+            continue;
+        }
+
+        uint32_t types = typesInSlice[d];
+        while (types) {
+            int type = countTrailingZeros(types);
+            types &= types - 1;
+            uint32_t* plane = rows[d][type];
+
+            for (int j = 0; j < dimensions[v]; j++) {
+                while (plane[j]) {
+                    int i = countTrailingZeros(plane[j]);
+                    int run = countTrailingZeros(~(plane[j] >> i));
+                    uint16_t lighting = faceKeys[d][j][i];
+                    const uint16_t* keys = faceKeys[d][j];
+                    int width = 1;
+                    while (width < run && keys[i + width] == lighting) width++;
+                    uint32_t runMask = ((width >= 32) ? ~0u : ((1u << width) - 1)) << i;
+
+                    plane[j] &= ~runMask;
+                    int height = 1;
+                    while (j + height < dimensions[v] && (plane[j + height] & runMask) == runMask) {
+                        const uint16_t* rowKeys = faceKeys[d][j + height];
+                        bool sameLighting = true;
+                        for (int k = i; k < i + width && sameLighting; k++) sameLighting = rowKeys[k] == lighting;
+                        if (!sameLighting) break;
+                        plane[j + height] &= ~runMask;
+                        height++;
+                    }
+
+                    addOptimizedQuad(out, axis, direction, i, j, d, width, height, u, v, w, VoxelType(type), lighting);
+                }
+            }
+        }
+    }
+    if (!translucent) sliceStart[normal][dimensions[w]] = uint32_t(vertices.size());
+}
+
+// Light of the voxel in front of the face in the low byte, then two bits of
+// ambient occlusion per corner in quad order: (-u,-v), (+u,-v), (+u,+v), (-u,+v).
+// A corner is darkened by each solid voxel among the two sides and the
+// diagonal next to it in the front layer. Downsampled meshes skip all of it.
+uint16_t ChunkMesher::faceLighting(const int pos[3], int direction, int u, int v, int w) const {
+    if (snapshot.lod > 0) return uint16_t(FULL_SKY_LIGHT | 0xFF00);
+
+    int front[3] = {pos[0], pos[1], pos[2]};
+    front[w] += direction;
+    auto solid = [&](int du, int dv) {
+        int p[3] = {front[0], front[1], front[2]};
+        p[u] += du;
+        p[v] += dv;
+        return isSolidVoxel(snapshot.get(p[0], p[1], p[2])) ? 1 : 0;
+    };
+
+    static const int cornerSigns[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    uint16_t key = snapshot.getLight(front[0], front[1], front[2]);
+    for (int c = 0; c < 4; c++) {
+        int su = cornerSigns[c][0];
+        int sv = cornerSigns[c][1];
+        int side1 = solid(su, 0);
+        int side2 = solid(0, sv);
+        int occlusion = (side1 && side2) ? 0 : 3 - side1 - side2 - solid(su, sv);
+        key |= uint16_t(occlusion << (8 + 2 * c));
+    }
+    return key;
+}
+
+void ChunkMesher::addOptimizedQuad(std::vector<ChunkVertex>& out, int axis, int direction, int i, int j, int d,
+                                   int width, int height, int u, int v, int w, VoxelType voxelType, uint16_t lighting) {
+    // Base position
+    int pos[3] = {0, 0, 0};
+    pos[u] = i;
+    pos[v] = j;
+    pos[w] = d;
+
+    // Offsets for quad corners
+    int du[3] = {0, 0, 0};
+    int dv[3] = {0, 0, 0};
+    du[u] = width;
+    dv[v] = height;
+
+    // Offset for face direction
+    int faceOffset = (direction > 0) ? 1 : 0;
+
+    // Four corners (explicitly for each face), chunk local so they fit the packed format
+    int normal = normalIndex(axis, direction);
+    uint8_t light = uint8_t(lighting & 0xFF);
+    ChunkVertex corners[4];
+    for (int c = 0; c < 4; ++c) {
+        int corner[3] = { pos[0], pos[1], pos[2] };
+        if (c == 1 || c == 2) corner[u] += du[u];
+        if (c == 2 || c == 3) corner[v] += dv[v];
+        corner[w] += faceOffset;
+        corners[c].data = packVertex(corner[0], corner[1], corner[2], normal, voxelType, snapshot.lod);
+        corners[c].light = packLight(light, (lighting >> (8 + 2 * c)) & 3);
+    }
+
+    // Winding order: flip for negative direction
+    int quad[4] = {0, 1, 2, 3};
+    if (direction < 0)
+        std::swap(quad[1], quad[3]);
+
+    // Special case for top face (Y+): ensure correct winding
+    if (axis == 1 && direction == 1) {
+        std::swap(quad[1], quad[3]);
+    }
+
+    // The shared index buffer splits quads along the first/third vertex diagonal.
+    // Rotating (keeps the winding) puts that diagonal between the brighter pair
+    // of corners, otherwise occlusion smears across the quad unevenly.
+    auto occlusion = [&](int c) { return (corners[quad[c]].light >> 8) & 3; };
+    int first = occlusion(0) + occlusion(2) < occlusion(1) + occlusion(3) ? 1 : 0;
+
+    // Four vertices per quad, the shared index buffer turns them into two triangles
+    for (int c = 0; c < 4; c++) {
+        out.push_back(corners[quad[(first + c) & 3]]);
+    }
+}
+
+void sortTranslucentQuads(std::vector<ChunkVertex>& vertices, const vec3& eye) {
+    struct QuadDepth {
+        float distanceSquared;
+        uint32_t first;
+    };
+    // Sorting runs on the main thread whenever the camera changes cell, keep the scratch around
+    static thread_local std::vector<QuadDepth> order;
+    static thread_local std::vector<ChunkVertex> sorted;
+
+    size_t quads = vertices.size() / VERTICES_PER_QUAD;
+    if (quads < 2) return;
+    order.resize(quads);
+    for (size_t q = 0; q < quads; q++) {
+        // Sum of the four corners is four times the centre, compare against 4 * eye
+        vec3 sum(0.0f);
+        for (int c = 0; c < VERTICES_PER_QUAD; c++) {
+            uint32_t data = vertices[q * VERTICES_PER_QUAD + c].data;
+            float scale = float(1u << ((data >> 26) & 3u));
+            sum += vec3(float(data & 31u), float((data >> 5) & 31u), float((data >> 10) & 31u)) * scale;
+        }
+        vec3 offset = sum - eye * 4.0f;
+        order[q] = {glm::dot(offset, offset), uint32_t(q * VERTICES_PER_QUAD)};
+    }
+    std::sort(order.begin(), order.end(), [](const QuadDepth& a, const QuadDepth& b) {
+        return a.distanceSquared > b.distanceSquared;
+    });
+
+    sorted.resize(vertices.size());
+    for (size_t q = 0; q < quads; q++) {
+        std::copy_n(vertices.begin() + order[q].first, VERTICES_PER_QUAD, sorted.begin() + q * VERTICES_PER_QUAD);
+    }
+    vertices.swap(sorted);
+}
@@ -0,0 +1,238 @@
+#include "Engine/ChunkRenderer.h"
+#include "Engine/ChunkMesher.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstddef>
+
+// 8M vertices (64 MiB) up front, doubled whenever a mesh doesn't fit
+constexpr uint32_t INITIAL_ARENA_VERTICES = 8 * 1024 * 1024;
+
+ChunkRenderer::ChunkRenderer()
+    : initialized(false), headless(false), VAO(0), vertexBuffer(0), quadIndexBuffer(0),
+      originBuffer(0), indirectBuffer(0), originCapacity(0), indirectCapacity(0),
+      occlusionCulling(true), triangleCount(0), opaqueCommandCount(0) {}
+
+ChunkRenderer::~ChunkRenderer() {
+    if (!initialized) return;
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &quadIndexBuffer);
+    glDeleteBuffers(1, &originBuffer);
+    glDeleteBuffers(1, &indirectBuffer);
+}
+
+// GL objects are created on first use so the world can be built before the context
+void ChunkRenderer::init() {
+    initialized = true;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &originBuffer);
+    glGenBuffers(1, &indirectBuffer);
+
+    glBindVertexArray(VAO);
+    createQuadIndexBuffer();
+
+    // Per-draw chunk origin, advanced once per instance
+    glBindBuffer(GL_ARRAY_BUFFER, originBuffer);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+
+    growVertexBuffer(INITIAL_ARENA_VERTICES);
+}
+
+void ChunkRenderer::createQuadIndexBuffer() {
+    std::vector<uint32_t> indices;
+    indices.reserve(MAX_QUADS_PER_SECTION * INDICES_PER_QUAD);
+    for (uint32_t quad = 0; quad < MAX_QUADS_PER_SECTION; quad++) {
+        uint32_t base = quad * VERTICES_PER_QUAD;
+        indices.push_back(base + 0);
+        indices.push_back(base + 1);
+        indices.push_back(base + 2);
+        indices.push_back(base + 0);
+        indices.push_back(base + 2);
+        indices.push_back(base + 3);
+    }
+
+    // Expects our VAO to be bound, the element buffer binding is VAO state
+    glGenBuffers(1, &quadIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+}
+
+// Reallocates the arena buffer and copies the live meshes over, offsets stay valid
+void ChunkRenderer::growVertexBuffer(uint32_t minCapacity) {
+    uint32_t oldCapacity = arena.getCapacity();
+    uint32_t newCapacity = std::max(oldCapacity * 2, minCapacity);
+    if (headless) {
+        arena.grow(newCapacity);
+        return;
+    }
+
+    GLuint newBuffer;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, newBuffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(newCapacity) * sizeof(ChunkVertex), nullptr, GL_DYNAMIC_DRAW);
+
+    if (oldCapacity > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, 0, 0, GLsizeiptr(oldCapacity) * sizeof(ChunkVertex));
+        glDeleteBuffers(1, &vertexBuffer);
+    }
+    vertexBuffer = newBuffer;
+    arena.grow(newCapacity);
+
+    // Two packed uint32 per vertex (see ChunkVertex), integer attributes so the shader can unpack the bits
+    glBindVertexArray(VAO);
+    glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(ChunkVertex), (void*)offsetof(ChunkVertex, data));
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(ChunkVertex), (void*)offsetof(ChunkVertex, light));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+}
+
+void ChunkRenderer::uploadMesh(MeshAllocation& mesh, const std::vector<ChunkVertex>& vertices) {
+    if (!initialized && !headless) init();
+    freeMesh(mesh);
+    if (vertices.empty()) return;
+
+    uint32_t count = uint32_t(vertices.size());
+    uint32_t offset;
+    if (!arena.allocate(count, offset)) {
+        growVertexBuffer(arena.getCapacity() + count);
+        arena.allocate(count, offset);
+    }
+
+    if (!headless) {
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, GLintptr(offset) * sizeof(ChunkVertex), GLsizeiptr(count) * sizeof(ChunkVertex), vertices.data());
+    }
+    mesh.offset = offset;
+    mesh.vertexCount = count;
+}
+
+void ChunkRenderer::updateMesh(MeshAllocation& mesh, const std::vector<ChunkVertex>& vertices) {
+    if (mesh.vertexCount == 0 || mesh.vertexCount != vertices.size()) {
+        uploadMesh(mesh, vertices);
+        return;
+    }
+    if (headless) return;
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, GLintptr(mesh.offset) * sizeof(ChunkVertex), GLsizeiptr(mesh.vertexCount) * sizeof(ChunkVertex), vertices.data());
+}
+
+void ChunkRenderer::freeMesh(MeshAllocation& mesh) {
+    if (mesh.vertexCount == 0) return;
+    arena.free(mesh.offset, mesh.vertexCount);
+    mesh = MeshAllocation();
+}
+
+void ChunkRenderer::beginFrame() {
+    commands.clear();
+    origins.clear();
+    translucentDraws.clear();
+    opaqueCommandCount = 0;
+    triangleCount = 0;
+}
+
+ChunkRenderer::DrawElementsIndirectCommand ChunkRenderer::makeCommand(const MeshAllocation& mesh) {
+    DrawElementsIndirectCommand command;
+    command.count = mesh.vertexCount / VERTICES_PER_QUAD * INDICES_PER_QUAD;
+    command.instanceCount = 1;
+    command.firstIndex = 0;
+    command.baseVertex = int32_t(mesh.offset);
+    command.baseInstance = 0;
+    return command;
+}
+
+void ChunkRenderer::addDraw(const MeshAllocation& mesh, const vec3& origin) {
+    if (mesh.vertexCount == 0) return;
+
+    DrawElementsIndirectCommand command = makeCommand(mesh);
+    command.baseInstance = uint32_t(origins.size());
+    commands.push_back(command);
+    triangleCount += command.count / 3;
+    origins.push_back(origin);
+}
+
+void ChunkRenderer::addTranslucentDraw(const MeshAllocation& mesh, const vec3& origin, float distanceSquared) {
+    if (mesh.vertexCount == 0) return;
+
+    TranslucentDraw draw{makeCommand(mesh), origin, distanceSquared};
+    translucentDraws.push_back(draw);
+    triangleCount += draw.command.count / 3;
+}
+
+// Re-specifying the same size with no data lets the driver hand us fresh
+// storage while the GPU still reads last frame's, without a real allocation
+void ChunkRenderer::streamBuffer(GLenum target, GLuint buffer, size_t& capacity, const void* data, size_t size) {
+    glBindBuffer(target, buffer);
+    if (size > capacity) {
+        capacity = std::max(size, capacity * 2);
+    }
+    glBufferData(target, GLsizeiptr(capacity), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(target, 0, GLsizeiptr(size), data);
+}
+
+void ChunkRenderer::draw() {
+    if ((commands.empty() && translucentDraws.empty()) || !initialized) return;
+
+    // Both passes share the streamed buffers, translucent commands and origins
+    // go after the opaque ones so the occlusion pass only sees the opaque prefix
+    opaqueCommandCount = commands.size();
+    std::sort(translucentDraws.begin(), translucentDraws.end(), [](const TranslucentDraw& a, const TranslucentDraw& b) {
+        return a.distanceSquared > b.distanceSquared;
+    });
+    for (const TranslucentDraw& translucent : translucentDraws) {
+        DrawElementsIndirectCommand command = translucent.command;
+        command.baseInstance = uint32_t(origins.size());
+        commands.push_back(command);
+        origins.push_back(translucent.origin);
+    }
+
+    streamBuffer(GL_ARRAY_BUFFER, originBuffer, originCapacity, origins.data(), origins.size() * sizeof(vec3));
+    streamBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer, indirectCapacity, commands.data(),
+                 commands.size() * sizeof(DrawElementsIndirectCommand));
+    if (occlusionCulling && opaqueCommandCount > 0) {
+        occlusion.cull(indirectBuffer, originBuffer, GLsizei(opaqueCommandCount));
+    }
+
+    if (opaqueCommandCount == 0) return;
+    glBindVertexArray(VAO);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, GLsizei(opaqueCommandCount), 0);
+    glBindVertexArray(0);
+}
+
+// Blended over the opaque scene with depth testing but no depth writes, both
+// sides drawn so the water surface shows from below as well
+void ChunkRenderer::drawTranslucent() {
+    if (translucentDraws.empty() || !initialized) return;
+
+    GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                (void*)(opaqueCommandCount * sizeof(DrawElementsIndirectCommand)),
+                                GLsizei(translucentDraws.size()), 0);
+    glBindVertexArray(0);
+
+    if (cullFace) glEnable(GL_CULL_FACE);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+void ChunkRenderer::captureDepth(const mat4& viewProj) {
+    if (occlusionCulling && initialized) occlusion.captureDepth(viewProj);
+}
+
+// The pyramid is stale after a stretch with culling off, start over without one
+void ChunkRenderer::setOcclusionCulling(bool enabled) {
+    if (enabled && !occlusionCulling) occlusion.invalidate();
+    occlusionCulling = enabled;
+}
@@ -1,102 +1,776 @@
 #include "Engine/InfiniteWorld.h"
+#include "Engine/ChunkMesher.h"
+#include "Engine/Profiler.h"
+#include "Generation/ColumnCache.h"
+#include <cmath>
 #include <iostream>
-InfiniteWorld::InfiniteWorld() {
+#include <memory>
+InfiniteWorld::InfiniteWorld()
+    : storage(ChunkStorage::directoryForSeed(GLOBAL_SEED)), lodCameraPosition(0.0f),
+      activeRenderDistance(RENDER_DISTANCE), loadedRenderDistance(RENDER_DISTANCE), lodDistanceScale(1.0f),
+      smoothedFrameMs(0.0f), framesSinceAdapt(0), appliedWorkerThreads(0), appliedColumnCacheDistance(-1), frameIndex(0), nextRetainSerial(0),
+      chunkPool(MAX_POOLED_CHUNKS), snapshotPool(MAX_POOLED_SNAPSHOTS), nextMeshJobId(0) {
     lastPlayerChunk = ChunkCoord(0, 0);
+    spareVertexBuffers.reserve(MAX_POOLED_VERTEX_BUFFERS);
 }
 
 InfiniteWorld::~InfiniteWorld() {
+    // Workers must be gone before we free anything they could still write to
+    workers.shutdown();
     for (auto& pair : chunks) {
-        delete pair.second;
+        saveChunk(pair.second);
+    }
+    // The pools own every chunk and snapshot, they are freed when the pools go
+    finishedChunks.clear();
+    for (auto& pair : chunks) {
+        destroyChunk(pair.second);
     }
     chunks.clear();
 }
 
+// Hooks a freshly adopted chunk up with its loaded neighbours, both ways
+void InfiniteWorld::linkNeighbours(Chunk* chunk) {
+    static const int offsets[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+    for (int i = 0; i < 4; i++) {
+        Chunk* neighbour = getChunk(ChunkCoord(chunk->coord.x + offsets[i][0], chunk->coord.z + offsets[i][1]));
+        chunk->neighbours[i] = neighbour;
+        // NEG_X <-> POS_X, NEG_Z <-> POS_Z
+        if (neighbour) neighbour->neighbours[i ^ 1] = chunk;
+    }
+}
+
+// Floodfill volume over the loaded world in world coordinates, see Lighting.h.
+// Every light change dirties the sections whose faces show it.
+class WorldLightVolume {
+public:
+    explicit WorldLightVolume(InfiniteWorld& world) : world(world), cursor(world) {}
+
+    bool contains(int x, int y, int z) {
+        return y >= 0 && y < CHUNK_HEIGHT && cursor.getChunk(x, z);
+    }
+    bool isTransparent(int x, int y, int z) {
+        return contains(x, y, z) && !isOpaqueVoxel(cursor.get(x, y, z));
+    }
+    int getLight(int x, int y, int z, LightChannel channel) {
+        return getLightLevel(cursor.getChunk(x, z)->getLight(worldToLocal(x), y, worldToLocal(z)), channel);
+    }
+    void setLight(int x, int y, int z, LightChannel channel, int level) {
+        Chunk* chunk = cursor.getChunk(x, z);
+        int localX = worldToLocal(x);
+        int localZ = worldToLocal(z);
+        chunk->setLight(localX, y, localZ, setLightLevel(chunk->getLight(localX, y, localZ), channel, level));
+        world.markVoxelDirty(chunk, localX, y, localZ, false);
+    }
+    int getEmission(int x, int y, int z) {
+        return getVoxelEmission(cursor.get(x, y, z));
+    }
+
+private:
+    InfiniteWorld& world;
+    VoxelCursor cursor;
+};
+
+// Light only crosses a chunk border once both sides are loaded. Border voxels
+// more than one level brighter than the voxel across from them seed the
+// floodfill, whichever side they are on.
+void InfiniteWorld::spreadBorderLight(Chunk* chunk) {
+    WorldLightVolume volume(*this);
+    int baseX = chunk->coord.x * CHUNK_SIZE;
+    int baseZ = chunk->coord.z * CHUNK_SIZE;
+    for (LightChannel channel : {LIGHT_SKY, LIGHT_BLOCK}) {
+        for (int i = 0; i < 4; i++) {
+            Chunk* neighbour = chunk->neighbours[i];
+            if (!neighbour) continue;
+            for (int t = 0; t < CHUNK_SIZE; t++) {
+                // Border voxel on our side and the one across in the neighbour, local coordinates
+                int x = i == NEIGHBOUR_NEG_X ? 0 : i == NEIGHBOUR_POS_X ? CHUNK_SIZE - 1 : t;
+                int z = i == NEIGHBOUR_NEG_Z ? 0 : i == NEIGHBOUR_POS_Z ? CHUNK_SIZE - 1 : t;
+                int acrossX = i == NEIGHBOUR_NEG_X ? CHUNK_SIZE - 1 : i == NEIGHBOUR_POS_X ? 0 : t;
+                int acrossZ = i == NEIGHBOUR_NEG_Z ? CHUNK_SIZE - 1 : i == NEIGHBOUR_POS_Z ? 0 : t;
+                int stepX = i == NEIGHBOUR_NEG_X ? -1 : i == NEIGHBOUR_POS_X ? 1 : 0;
+                int stepZ = i == NEIGHBOUR_NEG_Z ? -1 : i == NEIGHBOUR_POS_Z ? 1 : 0;
+                for (int y = 0; y < CHUNK_HEIGHT; y++) {
+                    int ours = getLightLevel(chunk->getLight(x, y, z), channel);
+                    int theirs = getLightLevel(neighbour->getLight(acrossX, y, acrossZ), channel);
+                    if (ours > theirs + 1) {
+                        lightQueues.add.push_back({baseX + x, y, baseZ + z, 0});
+                    } else if (theirs > ours + 1) {
+                        lightQueues.add.push_back({baseX + x + stepX, y, baseZ + z + stepZ, 0});
+                    }
+                }
+            }
+        }
+        propagateLight(volume, channel, lightQueues);
+    }
+}
+
+// Takes the light out of every changed voxel, floods back in from the
+// neighbours (and down from the open sky at the top of the world), then lets
+// any new emitters shine. One pass per channel for the whole set.
+void InfiniteWorld::relightVoxels(const glm::ivec3* voxels, size_t count) {
+    WorldLightVolume volume(*this);
+    for (LightChannel channel : {LIGHT_SKY, LIGHT_BLOCK}) {
+        for (size_t n = 0; n < count; n++) {
+            const glm::ivec3& p = voxels[n];
+            int level = volume.getLight(p.x, p.y, p.z, channel);
+            if (level > 0) {
+                volume.setLight(p.x, p.y, p.z, channel, 0);
+                lightQueues.remove.push_back({p.x, p.y, p.z, level});
+            }
+            if (channel == LIGHT_BLOCK && volume.getEmission(p.x, p.y, p.z) > 0) {
+                volume.setLight(p.x, p.y, p.z, channel, volume.getEmission(p.x, p.y, p.z));
+                lightQueues.add.push_back({p.x, p.y, p.z, 0});
+            }
+            if (!volume.isTransparent(p.x, p.y, p.z)) continue;
+
+            if (channel == LIGHT_SKY && p.y == CHUNK_HEIGHT - 1) {
+                volume.setLight(p.x, p.y, p.z, channel, MAX_LIGHT);
+                lightQueues.add.push_back({p.x, p.y, p.z, 0});
+            }
+            for (const auto& direction : LIGHT_DIRECTIONS) {
+                int x = p.x + direction[0];
+                int y = p.y + direction[1];
+                int z = p.z + direction[2];
+                if (volume.contains(x, y, z) && volume.getLight(x, y, z, channel) > 0) {
+                    lightQueues.add.push_back({x, y, z, 0});
+                }
+            }
+        }
+        removeLight(volume, channel, lightQueues);
+    }
+}
+
+// Queues the chunk for writing if it changed since it was last loaded or saved
+void InfiniteWorld::saveChunk(Chunk* chunk) {
+    if (!chunk->needsSave || !persistChunks) return;
+    std::vector<uint8_t> payload;
+    chunk->serialize(payload);
+    storage.saveChunkAsync(chunk->coord, std::move(payload));
+    chunk->needsSave = false;
+}
+
+// Returns the chunk's arena space before freeing it, main thread only
+void InfiniteWorld::destroyChunk(Chunk* chunk) {
+    for (int i = 0; i < 4; i++) {
+        if (chunk->neighbours[i]) chunk->neighbours[i]->neighbours[i ^ 1] = nullptr;
+    }
+    for (ChunkSection& section : chunk->sections) {
+        renderer.freeMesh(section.mesh);
+        renderer.freeMesh(section.translucentMesh);
+        recycleVertexBuffer(std::move(section.translucentVertices));
+    }
+    removeFromCullRegion(chunk);
+    chunk->releaseSectionData();
+    chunkPool.release(chunk);
+}
+
+ChunkCoord InfiniteWorld::cullRegionOf(ChunkCoord coord) {
+    return ChunkCoord(floorDiv(coord.x, CULL_REGION_CHUNKS), floorDiv(coord.z, CULL_REGION_CHUNKS));
+}
+
+void InfiniteWorld::addToCullRegion(Chunk* chunk) {
+    cullRegions[cullRegionOf(chunk->coord)].chunks.push_back(chunk);
+}
+
+void InfiniteWorld::removeFromCullRegion(Chunk* chunk) {
+    auto it = cullRegions.find(cullRegionOf(chunk->coord));
+    if (it == cullRegions.end()) return;
+    std::vector<Chunk*>& regionChunks = it->second.chunks;
+    auto position = std::find(regionChunks.begin(), regionChunks.end(), chunk);
+    if (position != regionChunks.end()) {
+        *position = regionChunks.back();
+        regionChunks.pop_back();
+    }
+    if (regionChunks.empty()) cullRegions.erase(it);
+}
+
+std::vector<ChunkVertex> InfiniteWorld::takeVertexBuffer() {
+    std::lock_guard<std::mutex> lock(vertexBufferMutex);
+    if (spareVertexBuffers.empty()) return {};
+    std::vector<ChunkVertex> vertices = std::move(spareVertexBuffers.back());
+    spareVertexBuffers.pop_back();
+    return vertices;
+}
+
+// Keeps the vector's capacity around for the next mesh job
+void InfiniteWorld::recycleVertexBuffer(std::vector<ChunkVertex>&& vertices) {
+    vertices.clear();
+    std::lock_guard<std::mutex> lock(vertexBufferMutex);
+    if (spareVertexBuffers.size() < MAX_POOLED_VERTEX_BUFFERS) {
+        spareVertexBuffers.push_back(std::move(vertices));
+    }
+}
+
 Chunk* InfiniteWorld::getChunk(ChunkCoord coord) {
     auto it = chunks.find(coord);
     if (it != chunks.end()) {
         return it->second;
     }
-    
-    Chunk* newChunk = new Chunk(coord, this);
-    chunks[coord] = newChunk;
-    markNeighbourChunksDirty(coord);
-    return newChunk;
+    return nullptr;
 }
 
+// Queues loading (from the region files) or generation on the worker pool, the chunk shows up in
+// `chunks` once processFinishedChunks() picks it up on the main thread
 void InfiniteWorld::loadChunk(ChunkCoord coord) {
-    getChunk(coord);
+    if (chunks.find(coord) != chunks.end() || pendingChunks.count(coord)) {
+        return;
+    }
+    pendingChunks[coord] = true;
+    RetainedPayload retained = takeRetainedChunk(coord);
+    if (retained) memoryStats.restoredChunks++;
+
+    workers.submit([this, coord, retained]() {
+        Chunk* chunk = chunkPool.acquire();
+        chunk->reset(coord, this);
+        bool loaded = retained && chunk->deserialize(*retained);
+        if (!loaded && persistChunks) loaded = storage.loadChunk(coord, *chunk);
+        if (!loaded) {
+            PROFILE_SCOPE(PROFILE_TERRAIN_GENERATION);
+            chunk->generateTerrain();
+        }
+        chunk->computeLight();
+
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        finishedChunks.push_back(chunk);
+    });
+}
+
+void InfiniteWorld::processFinishedChunks() {
+    processFinishedChunks(std::chrono::steady_clock::time_point::max());
+}
+
+// Adopts finished chunks until `deadline`, the rest stay queued for next frame
+void InfiniteWorld::processFinishedChunks(std::chrono::steady_clock::time_point deadline) {
+    std::vector<Chunk*>& ready = adoptingChunks;
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        ready.swap(finishedChunks);
+    }
+
+    for (size_t i = 0; i < ready.size(); i++) {
+        if (i > 0 && std::chrono::steady_clock::now() >= deadline) {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            finishedChunks.insert(finishedChunks.end(), ready.begin() + i, ready.end());
+            break;
+        }
+
+        Chunk* chunk = ready[i];
+        ChunkCoord coord = chunk->coord;
+        pendingChunks.erase(coord);
+
+        // The player may have moved on while this one was generating, it may
+        // have been a retained copy so keep it as one
+        if (!isChunkInRange(coord, lastPlayerChunk)) {
+            retainChunk(chunk);
+            chunk->releaseSectionData();
+            chunkPool.release(chunk);
+            continue;
+        }
+
+        chunk->lod = selectLod(chunk, lodCameraPosition);
+        chunk->lastSeenFrame = frameIndex;
+        chunks[coord] = chunk;
+        addToCullRegion(chunk);
+        linkNeighbours(chunk);
+        spreadBorderLight(chunk);
+        markNeighbourChunksDirty(coord);
+        Profiler::get().getCounters().chunksLoaded++;
+    }
+    ready.clear();
+}
+
+// A full section whose six neighbours are full too has no visible faces
+bool InfiniteWorld::isSectionHidden(Chunk* chunk, int sectionIndex) {
+    if (!chunk->sections[sectionIndex].isFull()) return false;
+
+    // Below the world counts as solid (the underside is never drawn), above as air
+    if (sectionIndex > 0 && !chunk->sections[sectionIndex - 1].isFull()) return false;
+    if (sectionIndex + 1 >= SECTIONS_PER_CHUNK || !chunk->sections[sectionIndex + 1].isFull()) return false;
+
+    for (Chunk* neighbour : chunk->neighbours) {
+        if (!neighbour || !neighbour->sections[sectionIndex].isFull()) return false;
+    }
+    return true;
+}
+
+// Snapshots every dirty section and hands it to the pool for meshing. Chunks
+// with a neighbour still generating wait, that neighbour would dirty them again.
+void InfiniteWorld::scheduleMeshJobs() {
+    for (auto& [coord, chunk] : chunks) {
+        if (pendingChunks.count(ChunkCoord(coord.x - 1, coord.z)) ||
+            pendingChunks.count(ChunkCoord(coord.x + 1, coord.z)) ||
+            pendingChunks.count(ChunkCoord(coord.x, coord.z - 1)) ||
+            pendingChunks.count(ChunkCoord(coord.x, coord.z + 1))) {
+            continue;
+        }
+
+        for (int s = 0; s < SECTIONS_PER_CHUNK; s++) {
+            ChunkSection& section = chunk->sections[s];
+            if (!section.meshDirty || section.meshJobId != 0) continue;
+
+            // Nothing to draw, skip the round trip through the pool
+            if (section.isEmpty() || isSectionHidden(chunk, s)) {
+                renderer.freeMesh(section.mesh);
+                renderer.freeMesh(section.translucentMesh);
+                recycleVertexBuffer(std::move(section.translucentVertices));
+                section.meshCache.reset();
+                section.meshDirty = false;
+                continue;
+            }
+
+            SectionSnapshot* snapshot = snapshotPool.acquire();
+            chunk->takeSnapshot(s, *snapshot);
+            section.meshDirty = false;
+            section.meshJobId = ++nextMeshJobId;
+            snapshot->jobId = section.meshJobId;
+
+            // Edited sections remesh only their dirty slices against the cached
+            // mesh, which travels with the job. Downsampled meshes are always rebuilt.
+            snapshot->keepCache = section.keepMeshCache && chunk->lod == 0;
+            if (snapshot->keepCache) snapshot->cache = std::move(section.meshCache);
+            section.meshCache.reset();
+            for (int axis = 0; axis < 3; axis++) {
+                snapshot->dirtySlices[axis] = section.dirtySlices[axis];
+                section.dirtySlices[axis] = 0;
+            }
+
+            // Two pointers fit std::function's inline storage, no allocation per job
+            workers.submit([this, snapshot]() {
+                MeshResult result{snapshot->coord, snapshot->sectionIndex, snapshot->jobId, takeVertexBuffer(),
+                                  takeVertexBuffer(), nullptr};
+                {
+                    PROFILE_SCOPE(PROFILE_MESHING);
+                    downsampleSnapshot(*snapshot);
+                    ChunkMesher mesher(*snapshot, result.vertices, result.translucentVertices);
+                    mesher.generateMesh(snapshot->cache.get());
+                    if (snapshot->keepCache) {
+                        if (!snapshot->cache) snapshot->cache = std::make_unique<SectionMeshCache>();
+                        mesher.copySliceStarts(*snapshot->cache);
+                        result.cache = std::move(snapshot->cache);
+                    }
+                }
+                snapshot->cache.reset();
+                snapshotPool.release(snapshot);
+
+                std::lock_guard<std::mutex> lock(finishedMeshMutex);
+                finishedMeshes.push_back(std::move(result));
+            });
+        }
+    }
+}
+
+// Uploads at most settings.maxMeshUploadsPerFrame buffers (or roughly
+// settings.maxMeshUploadBytesPerFrame), the rest waits for the next frame
+void InfiniteWorld::uploadFinishedMeshes() {
+    PROFILE_SCOPE(PROFILE_MESH_UPLOAD);
+    {
+        std::lock_guard<std::mutex> lock(finishedMeshMutex);
+        for (MeshResult& result : finishedMeshes) {
+            readyMeshes.push_back(std::move(result));
+        }
+        finishedMeshes.clear();
+    }
+
+    int uploads = 0;
+    size_t uploadedBytes = 0;
+    size_t consumed = 0;
+    while (consumed < readyMeshes.size() && uploads < settings.maxMeshUploadsPerFrame &&
+           uploadedBytes < settings.maxMeshUploadBytesPerFrame) {
+        MeshResult& result = readyMeshes[consumed++];
+
+        // Drop results for chunks that were unloaded (or reloaded) in the meantime
+        Chunk* chunk = getChunk(result.coord);
+        if (chunk && chunk->sections[result.sectionIndex].meshJobId == result.jobId) {
+            ChunkSection& section = chunk->sections[result.sectionIndex];
+            uploadedBytes += (result.vertices.size() + result.translucentVertices.size()) * sizeof(ChunkVertex);
+            renderer.uploadMesh(section.mesh, result.vertices);
+            // Sorted for the last camera position, render() keeps it sorted from there
+            glm::vec3 origin(result.coord.x * CHUNK_SIZE, result.sectionIndex * SECTION_SIZE, result.coord.z * CHUNK_SIZE);
+            sortTranslucentQuads(result.translucentVertices, lodCameraPosition - origin);
+            renderer.uploadMesh(section.translucentMesh, result.translucentVertices);
+            section.translucentVertices.swap(result.translucentVertices);
+            section.translucentSortCell = glm::ivec3(glm::floor(lodCameraPosition));
+            // The cache keeps the new vertices, its old ones get recycled below
+            if (result.cache) {
+                result.cache->vertices.swap(result.vertices);
+                section.meshCache = std::move(result.cache);
+            }
+            section.meshJobId = 0;
+            uploads++;
+        }
+        recycleVertexBuffer(std::move(result.vertices));
+        recycleVertexBuffer(std::move(result.translucentVertices));
+    }
+    readyMeshes.erase(readyMeshes.begin(), readyMeshes.begin() + consumed);
+    Profiler::get().getCounters().bytesUploaded += uploadedBytes;
+    Profiler::get().getCounters().meshesUploaded += uploads;
 }
 
 void InfiniteWorld::update(const Camera& camera) {
+    PROFILE_SCOPE(PROFILE_WORLD_UPDATE);
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double, std::milli>(CHUNK_STREAMING_BUDGET_MS));
+
+    frameIndex++;
+    if (settings.workerThreads != appliedWorkerThreads) {
+        workers.setThreadCount(unsigned(std::max(settings.workerThreads, 0)));
+        appliedWorkerThreads = settings.workerThreads;
+    }
+    // Columns of every chunk that can stay loaded, so reloads don't run the noise again
+    int keptDistance = std::max(settings.renderDistance, 1) + settings.unloadMargin;
+    if (keptDistance != appliedColumnCacheDistance) {
+        ColumnCache::get().setMaxRegions(std::max(ColumnCache::regionsForDistance(keptDistance),
+                                                  size_t(COLUMN_CACHE_MAX_REGIONS)));
+        appliedColumnCacheDistance = keptDistance;
+    }
+    // Adaptive quality only ever stays below the chosen distance
+    int maxDistance = std::max(settings.renderDistance, 1);
+    activeRenderDistance = settings.adaptiveQuality ? std::min(activeRenderDistance, maxDistance) : maxDistance;
+    maxDrawDistance = (activeRenderDistance + 0.5f) * CHUNK_SIZE;
+
     ChunkCoord playerChunk = camera.getCurrentChunkCoord();
-    
-    if (!(playerChunk == lastPlayerChunk)) {
-        lastPlayerChunk = playerChunk;
+    if (!(playerChunk == lastPlayerChunk) || activeRenderDistance != loadedRenderDistance) {
         loadChunksAroundPlayer(playerChunk);
         unloadDistantChunks(playerChunk);
     }
+
+    processFinishedChunks(deadline);
+    streamChunks(camera, deadline);
+    scheduleMeshJobs();
+    uploadFinishedMeshes();
+    updateMemoryStats();
+    enforceMemoryBudget(playerChunk);
 }
 
+// Replaces the request list with every chunk in range that isn't loaded or loading yet
 void InfiniteWorld::loadChunksAroundPlayer(ChunkCoord playerChunk) {
-    for (int x = playerChunk.x - RENDER_DISTANCE; x <= playerChunk.x + RENDER_DISTANCE; x++) {
-        for (int z = playerChunk.z - RENDER_DISTANCE; z <= playerChunk.z + RENDER_DISTANCE; z++) {
+    lastPlayerChunk = playerChunk;
+    loadedRenderDistance = activeRenderDistance;
+    loadRequests.clear();
+    int distance = activeRenderDistance;
+    for (int x = playerChunk.x - distance; x <= playerChunk.x + distance; x++) {
+        for (int z = playerChunk.z - distance; z <= playerChunk.z + distance; z++) {
             ChunkCoord coord(x, z);
-            if (chunks.find(coord) == chunks.end()) {
-                loadChunk(coord);
+            if (chunks.find(coord) == chunks.end() && !pendingChunks.count(coord)) {
+                loadRequests.push_back({coord, 0.0f});
             }
         }
     }
 }
 
+// Hands the most urgent requests to the pool: nearest first, chunks in the
+// view frustum count as half as far away. Only MAX_PENDING_CHUNK_LOADS are in
+// flight at once so a turn of the camera reorders what's still waiting.
+void InfiniteWorld::streamChunks(const Camera& camera, std::chrono::steady_clock::time_point deadline) {
+    if (loadRequests.empty() || pendingChunks.size() >= MAX_PENDING_CHUNK_LOADS) return;
+
+    for (LoadRequest& request : loadRequests) {
+        glm::vec3 min(request.coord.x * CHUNK_SIZE, 0, request.coord.z * CHUNK_SIZE);
+        glm::vec3 max(min.x + CHUNK_SIZE, CHUNK_HEIGHT, min.z + CHUNK_SIZE);
+        float dx = (min.x + CHUNK_SIZE * 0.5f - camera.position.x) / CHUNK_SIZE;
+        float dz = (min.z + CHUNK_SIZE * 0.5f - camera.position.z) / CHUNK_SIZE;
+        float distance = std::sqrt(dx * dx + dz * dz);
+        request.priority = frustum.isBoxVisible(min, max) ? distance : distance * 2.0f;
+    }
+    // Most urgent at the back so dispatching pops from the end
+    std::sort(loadRequests.begin(), loadRequests.end(), [](const LoadRequest& a, const LoadRequest& b) {
+        return a.priority > b.priority;
+    });
+
+    while (!loadRequests.empty() && pendingChunks.size() < MAX_PENDING_CHUNK_LOADS &&
+           std::chrono::steady_clock::now() < deadline) {
+        loadChunk(loadRequests.back().coord);
+        loadRequests.pop_back();
+    }
+}
+
+// Loaded chunks stay until they are settings.unloadMargin past the render distance
+bool InfiniteWorld::isChunkInRange(ChunkCoord coord, ChunkCoord playerChunk) const {
+    int range = activeRenderDistance + settings.unloadMargin;
+    return abs(coord.x - playerChunk.x) <= range && abs(coord.z - playerChunk.z) <= range;
+}
+
 void InfiniteWorld::unloadDistantChunks(ChunkCoord playerChunk) {
-    std::vector<ChunkCoord> chunksToRemove;
-    
-    for (auto& pair : chunks) {
-        ChunkCoord chunkCoord = pair.first;
-        int dx = abs(chunkCoord.x - playerChunk.x);
-        int dz = abs(chunkCoord.z - playerChunk.z);
-        
-        if (dx > RENDER_DISTANCE + 2 || dz > RENDER_DISTANCE + 2) {
-            chunksToRemove.push_back(chunkCoord);
+    unloadCandidates.clear();
+    for (auto& [coord, chunk] : chunks) {
+        if (!isChunkInRange(coord, playerChunk)) unloadCandidates.push_back(chunk);
+    }
+    for (Chunk* chunk : unloadCandidates) {
+        unloadChunk(chunk);
+    }
+}
+
+void InfiniteWorld::unloadChunk(Chunk* chunk) {
+    ChunkCoord coord = chunk->coord;
+    saveChunk(chunk);
+    retainChunk(chunk);
+    destroyChunk(chunk);
+    chunks.erase(coord);
+}
+
+void InfiniteWorld::retainChunk(Chunk* chunk) {
+    if (settings.retainedChunkBudget == 0) return;
+    std::vector<uint8_t> payload;
+    chunk->serialize(payload);
+    memoryStats.retainedBytes += payload.size();
+
+    auto it = retainedChunks.find(chunk->coord);
+    if (it != retainedChunks.end()) {
+        memoryStats.retainedBytes -= it->second.payload->size();
+        retainedChunks.erase(it);
+    }
+    unsigned long serial = ++nextRetainSerial;
+    retainedChunks[chunk->coord] = {std::make_shared<const std::vector<uint8_t>>(std::move(payload)), serial};
+    retainedOrder.push_back({chunk->coord, serial});
+    trimRetainedChunks(settings.retainedChunkBudget);
+}
+
+InfiniteWorld::RetainedPayload InfiniteWorld::takeRetainedChunk(ChunkCoord coord) {
+    auto it = retainedChunks.find(coord);
+    if (it == retainedChunks.end()) return nullptr;
+    RetainedPayload payload = std::move(it->second.payload);
+    memoryStats.retainedBytes -= payload->size();
+    retainedChunks.erase(it);
+    // Taken copies leave stale entries behind, sweep them once they pile up
+    if (retainedOrder.size() > retainedChunks.size() * 2 + 64) {
+        std::deque<std::pair<ChunkCoord, unsigned long>> live;
+        for (auto& [orderCoord, serial] : retainedOrder) {
+            auto entry = retainedChunks.find(orderCoord);
+            if (entry != retainedChunks.end() && entry->second.serial == serial) live.push_back({orderCoord, serial});
         }
+        retainedOrder.swap(live);
+    }
+    return payload;
+}
+
+void InfiniteWorld::trimRetainedChunks(size_t limit) {
+    while (memoryStats.retainedBytes > limit && !retainedOrder.empty()) {
+        auto [coord, serial] = retainedOrder.front();
+        retainedOrder.pop_front();
+        auto it = retainedChunks.find(coord);
+        if (it == retainedChunks.end() || it->second.serial != serial) continue;
+        memoryStats.retainedBytes -= it->second.payload->size();
+        retainedChunks.erase(it);
     }
-    
-    for (ChunkCoord coord : chunksToRemove) {
-        auto it = chunks.find(coord);
-        if (it != chunks.end()) {
-            Chunk* chunk = it->second;
-                delete chunk;
-                std::cout << "Unloaded chunk at (" << coord.x << ", " << coord.z << ")" << std::endl;
-                chunks.erase(it);
+}
+
+void InfiniteWorld::updateMemoryStats() {
+    size_t voxelBytes = 0;
+    size_t meshBytes = 0;
+    for (auto& [coord, chunk] : chunks) {
+        voxelBytes += chunk->getVoxelMemoryUsage();
+        meshBytes += chunk->getMeshMemoryUsage();
+    }
+    memoryStats.voxelBytes = voxelBytes;
+    memoryStats.cpuMeshBytes = meshBytes;
+    memoryStats.gpuMeshBytes = size_t(renderer.getArena().getUsed()) * sizeof(ChunkVertex);
+    memoryStats.gpuMeshCapacityBytes = size_t(renderer.getArena().getCapacity()) * sizeof(ChunkVertex);
+    memoryStats.retainedChunks = int(retainedChunks.size());
+}
+
+// Over settings.memoryBudget, unloads chunks in the unload margin (past the
+// render distance, so they aren't simply requested again) least recently seen
+// first and furthest first among those. Retained copies go after that.
+void InfiniteWorld::enforceMemoryBudget(ChunkCoord playerChunk) {
+    size_t budget = settings.memoryBudget;
+    if (budget == 0 || memoryStats.getTotal() <= budget) return;
+
+    auto distanceOf = [playerChunk](const Chunk* chunk) {
+        return std::max(abs(chunk->coord.x - playerChunk.x), abs(chunk->coord.z - playerChunk.z));
+    };
+    unloadCandidates.clear();
+    for (auto& [coord, chunk] : chunks) {
+        if (distanceOf(chunk) > activeRenderDistance) unloadCandidates.push_back(chunk);
+    }
+    std::sort(unloadCandidates.begin(), unloadCandidates.end(), [&](const Chunk* a, const Chunk* b) {
+        if (a->lastSeenFrame != b->lastSeenFrame) return a->lastSeenFrame < b->lastSeenFrame;
+        return distanceOf(a) > distanceOf(b);
+    });
+
+    for (Chunk* chunk : unloadCandidates) {
+        if (memoryStats.getTotal() <= budget) break;
+        size_t voxelBytes = chunk->getVoxelMemoryUsage();
+        size_t meshBytes = chunk->getMeshMemoryUsage();
+        unloadChunk(chunk);
+        memoryStats.voxelBytes -= voxelBytes;
+        memoryStats.cpuMeshBytes -= meshBytes;
+        memoryStats.gpuMeshBytes = size_t(renderer.getArena().getUsed()) * sizeof(ChunkVertex);
+        memoryStats.evictedChunks++;
+    }
+
+    size_t total = memoryStats.getTotal();
+    if (total > budget) {
+        size_t excess = total - budget;
+        trimRetainedChunks(memoryStats.retainedBytes > excess ? memoryStats.retainedBytes - excess : 0);
+    }
+    memoryStats.retainedChunks = int(retainedChunks.size());
+}
+
+// Squared horizontal distance from a point to the nearest point of a box
+static float horizontalDistanceSquared(const glm::vec3& point, const glm::vec3& min, const glm::vec3& max) {
+    float dx = std::max(std::max(min.x - point.x, point.x - max.x), 0.0f);
+    float dz = std::max(std::max(min.z - point.z, point.z - max.z), 0.0f);
+    return dx * dx + dz * dz;
+}
+
+// Level of detail for a chunk by its horizontal distance to the camera. Moving
+// to a coarser level takes LOD_HYSTERESIS more, moving back doesn't.
+int InfiniteWorld::selectLod(const Chunk* chunk, const glm::vec3& cameraPosition) const {
+    if (!levelOfDetail) return 0;
+
+    glm::vec3 min(chunk->coord.x * CHUNK_SIZE, 0, chunk->coord.z * CHUNK_SIZE);
+    glm::vec3 max(min.x + CHUNK_SIZE, CHUNK_HEIGHT, min.z + CHUNK_SIZE);
+    float distance = std::sqrt(horizontalDistanceSquared(cameraPosition, min, max));
+
+    float baseDistance = LOD_BASE_DISTANCE * lodDistanceScale;
+    auto lodForDistance = [baseDistance](float d) {
+        int lod = 0;
+        while (lod + 1 < LOD_LEVELS && d >= baseDistance * float(1 << lod)) lod++;
+        return lod;
+    };
+    int lod = lodForDistance(distance);
+    if (lod > chunk->lod) lod = std::max(lodForDistance(distance - LOD_HYSTERESIS), chunk->lod);
+    return lod;
+}
+
+// Remeshes chunks whose level changed. Downsampled neighbours are remeshed too,
+// their seam walls depend on this chunk's level (see Chunk::takeSnapshot).
+// The old mesh stays on screen until the new one is uploaded.
+void InfiniteWorld::updateLevelsOfDetail(const glm::vec3& cameraPosition) {
+    lodCameraPosition = cameraPosition;
+    for (auto& [coord, chunk] : chunks) {
+        int lod = selectLod(chunk, cameraPosition);
+        if (lod == chunk->lod) continue;
+
+        chunk->lod = lod;
+        chunk->markAllSectionsDirty();
+        for (Chunk* neighbour : chunk->neighbours) {
+            if (neighbour && neighbour->lod > 0) neighbour->markAllSectionsDirty();
         }
     }
 }
 
-void InfiniteWorld::render(const glm::mat4& viewProj) {
+// Steps down when the smoothed frame time is over target or memory is over
+// budget, up again once both have clear headroom. Memory only shrinks with
+// the render distance, frame time tries the cheaper LOD rings first.
+void InfiniteWorld::adaptQuality(float frameMs, size_t memoryBytes) {
+    smoothedFrameMs += (frameMs - smoothedFrameMs) * 0.05f;
+    if (!settings.adaptiveQuality) {
+        lodDistanceScale = 1.0f;
+        return;
+    }
+    if (++framesSinceAdapt < ADAPT_INTERVAL_FRAMES) return;
+
+    bool overMemory = settings.memoryBudget > 0 && memoryBytes > settings.memoryBudget;
+    bool memoryHeadroom = settings.memoryBudget == 0 || memoryBytes < settings.memoryBudget / 10 * 9;
+    int minDistance = std::min(settings.minRenderDistance, settings.renderDistance);
+    if (smoothedFrameMs > settings.targetFrameMs * 1.1f || overMemory) {
+        if (!overMemory && lodDistanceScale > MIN_LOD_DISTANCE_SCALE) {
+            lodDistanceScale = std::max(lodDistanceScale - 0.25f, MIN_LOD_DISTANCE_SCALE);
+        } else if (activeRenderDistance > minDistance) {
+            activeRenderDistance--;
+        }
+        framesSinceAdapt = 0;
+    } else if (smoothedFrameMs < settings.targetFrameMs * 0.75f && memoryHeadroom) {
+        if (activeRenderDistance < settings.renderDistance) {
+            activeRenderDistance++;
+        } else if (lodDistanceScale < 1.0f) {
+            lodDistanceScale = std::min(lodDistanceScale + 0.25f, 1.0f);
+        }
+        framesSinceAdapt = 0;
+    }
+}
+
+// Collects every visible section into one multi-draw, see ChunkRenderer.
+// Regions that are fully inside the frustum accept their chunks without
+// testing them, regions outside reject theirs the same way. Translucent
+// meshes are drawn afterwards, furthest section first.
+void InfiniteWorld::render(const glm::mat4& viewProj, const glm::vec3& cameraPosition) {
+    PROFILE_SCOPE(PROFILE_RENDER);
+    FrameCounters& counters = Profiler::get().getCounters();
+    updateLevelsOfDetail(cameraPosition);
     frustum.update(viewProj);
-    
-    for (auto& [coord, chunk] : chunks) {
-        glm::vec3 min(
-            coord.x * CHUNK_SIZE,
-            0,
-            coord.z * CHUNK_SIZE
-        );
-        
-        glm::vec3 max(
-            min.x + CHUNK_SIZE,
-            CHUNK_HEIGHT,
-            min.z + CHUNK_SIZE
-        );
+    renderer.beginFrame();
+    const float maxDistanceSquared = maxDrawDistance * maxDrawDistance;
+    const float regionSize = float(CULL_REGION_CHUNKS * CHUNK_SIZE);
+    const glm::ivec3 cameraCell(glm::floor(cameraPosition));
+    const glm::vec3 sectionHalfSize(CHUNK_SIZE * 0.5f, SECTION_SIZE * 0.5f, CHUNK_SIZE * 0.5f);
+
+    for (auto& [regionCoord, region] : cullRegions) {
+        glm::vec3 regionMin(regionCoord.x * regionSize, 0, regionCoord.z * regionSize);
+        glm::vec3 regionMax(regionMin.x + regionSize, CHUNK_HEIGHT, regionMin.z + regionSize);
 
-        if (frustum.isBoxVisible(min, max)) {
-            chunk->render();
+        unsigned regionMask = Frustum::ALL_PLANES;
+        if (horizontalDistanceSquared(cameraPosition, regionMin, regionMax) > maxDistanceSquared ||
+            frustum.classifyBox(regionMin, regionMax, regionMask, region.planeHint) == Frustum::Outside) {
+            counters.culledChunks += int(region.chunks.size());
+            continue;
+        }
+
+        for (Chunk* chunk : region.chunks) {
+            glm::vec3 min(chunk->coord.x * CHUNK_SIZE, 0, chunk->coord.z * CHUNK_SIZE);
+            glm::vec3 max(min.x + CHUNK_SIZE, CHUNK_HEIGHT, min.z + CHUNK_SIZE);
+
+            unsigned chunkMask = regionMask;
+            if (horizontalDistanceSquared(cameraPosition, min, max) > maxDistanceSquared ||
+                (chunkMask && frustum.classifyBox(min, max, chunkMask, chunk->cullPlaneHint) == Frustum::Outside)) {
+                counters.culledChunks++;
+                continue;
+            }
+            counters.visibleChunks++;
+            chunk->lastSeenFrame = frameIndex;
+
+            int sectionHint = chunk->cullPlaneHint;
+            for (int s = 0; s < SECTIONS_PER_CHUNK; s++) {
+                ChunkSection& section = chunk->sections[s];
+                if (section.mesh.vertexCount == 0 && section.translucentMesh.vertexCount == 0) continue;
+
+                glm::vec3 sectionMin(min.x, s * SECTION_SIZE, min.z);
+                glm::vec3 sectionMax(max.x, (s + 1) * SECTION_SIZE, max.z);
+                unsigned sectionMask = chunkMask;
+                if (sectionMask && frustum.classifyBox(sectionMin, sectionMax, sectionMask, sectionHint) == Frustum::Outside) {
+                    counters.culledSections++;
+                    continue;
+                }
+                renderer.addDraw(section.mesh, sectionMin);
+                counters.visibleSections++;
+                if (section.translucentMesh.vertexCount == 0) continue;
+
+                glm::vec3 offset = sectionMin + sectionHalfSize - cameraPosition;
+                float distanceSquared = glm::dot(offset, offset);
+                // Only when the camera moved to another voxel, so a still camera sorts nothing
+                if (section.translucentSortCell != cameraCell &&
+                    distanceSquared < TRANSLUCENT_SORT_DISTANCE * TRANSLUCENT_SORT_DISTANCE) {
+                    sortTranslucentQuads(section.translucentVertices, cameraPosition - sectionMin);
+                    renderer.updateMesh(section.translucentMesh, section.translucentVertices);
+                    section.translucentSortCell = cameraCell;
+                }
+                renderer.addTranslucentDraw(section.translucentMesh, sectionMin, distanceSquared);
+            }
         }
     }
+
+    renderer.draw();
+    renderer.captureDepth(viewProj);
+    renderer.drawTranslucent();
+    counters.occludedSections = renderer.getOccludedCount();
+    counters.drawCalls += renderer.getDrawCount();
+    counters.triangles += renderer.getTriangleCount();
+    counters.meshMemory = size_t(renderer.getArena().getUsed()) * sizeof(ChunkVertex);
+}
+
+size_t InfiniteWorld::getVoxelMemoryUsage() {
+    size_t bytes = 0;
+    for (auto& [coord, chunk] : chunks) {
+        bytes += chunk->getMemoryUsage();
+    }
+    return bytes;
 }
 
 bool InfiniteWorld::isVoxelSolidAt(int worldX, int worldY, int worldZ) {
-    int chunkX = (int)floor((float)worldX / CHUNK_SIZE);
-    int chunkZ = (int)floor((float)worldZ / CHUNK_SIZE);
+    int chunkX = worldToChunk(worldX);
+    int chunkZ = worldToChunk(worldZ);
 
     ChunkCoord coord(chunkX, chunkZ);
     auto it = chunks.find(coord);
@@ -106,9 +780,9 @@ bool InfiniteWorld::isVoxelSolidAt(int worldX, int worldY, int worldZ) {
 
     Chunk* chunk = it->second;
 
-    int localX = worldX - (chunkX * CHUNK_SIZE);
+    int localX = worldToLocal(worldX);
     int localY = worldY;
-    int localZ = worldZ - (chunkZ * CHUNK_SIZE);
+    int localZ = worldToLocal(worldZ);
 
     if (localX < 0 || localX >= CHUNK_SIZE ||
         localY < 0 || localY >= CHUNK_HEIGHT || 
@@ -116,12 +790,12 @@ bool InfiniteWorld::isVoxelSolidAt(int worldX, int worldY, int worldZ) {
         return false;
     }
 
-    return chunk->voxels[localX][localY][localZ].isActive;
+    return chunk->getVoxel(localX, localY, localZ) != AIR;
 }
 
 void InfiniteWorld::setVoxel(int worldX, int worldY, int worldZ, VoxelType type) {
-    int chunkX = (int)floor((float)worldX / CHUNK_SIZE);
-    int chunkZ = (int)floor((float)worldZ / CHUNK_SIZE);
+    int chunkX = worldToChunk(worldX);
+    int chunkZ = worldToChunk(worldZ);
 
     ChunkCoord coord(chunkX, chunkZ);
     auto it = chunks.find(coord);
@@ -131,9 +805,9 @@ void InfiniteWorld::setVoxel(int worldX, int worldY, int worldZ, VoxelType type)
 
     Chunk* chunk = it->second;
 
-    int localX = worldX - (chunkX * CHUNK_SIZE);
+    int localX = worldToLocal(worldX);
     int localY = worldY;
-    int localZ = worldZ - (chunkZ * CHUNK_SIZE);
+    int localZ = worldToLocal(worldZ);
 
     if (localX < 0 || localX >= CHUNK_SIZE ||
         localY < 0 || localY >= CHUNK_HEIGHT || 
@@ -141,24 +815,101 @@ void InfiniteWorld::setVoxel(int worldX, int worldY, int worldZ, VoxelType type)
         return; // Out of bounds
     }
 
-    chunk->voxels[localX][localY][localZ] = Voxel(type);
-    chunk->meshDirty = true;
-    markNeighbourChunksDirty(coord);
+    if (chunk->getVoxel(localX, localY, localZ) == type) {
+        return;
+    }
+    chunk->setVoxel(localX, localY, localZ, type);
+    chunk->needsSave = true;
+    markVoxelDirty(chunk, localX, localY, localZ);
+    glm::ivec3 voxel(worldX, worldY, worldZ);
+    relightVoxels(&voxel, 1);
+}
+
+// Slices p - 1, p and p + 1 along one axis, the faces an edit at p can change
+static uint32_t slicesAround(int p) {
+    return (7u << p) >> 1;
+}
+
+// Remesh the touched section, plus whichever neighbours share the faces of this
+// voxel or the corners their ambient occlusion reads, diagonal ones included.
+// Only the slices around the voxel are dirtied, see SectionSnapshot::dirtySlices.
+void InfiniteWorld::markVoxelDirty(Chunk* chunk, int localX, int localY, int localZ, bool edited) {
+    int sectionIndex = localY / SECTION_SIZE;
+    int local[3] = {localX, localY % SECTION_SIZE, localZ};
+    int sizes[3] = {CHUNK_SIZE, SECTION_SIZE, CHUNK_SIZE};
+    // Per axis, -1/+1 reach the section or chunk before/after when the voxel is on that border
+    auto reaches = [&](int axis, int offset) {
+        return offset == 0 || (offset < 0 ? local[axis] == 0 : local[axis] == sizes[axis] - 1);
+    };
+    auto slices = [&](int axis, int offset) {
+        return offset == 0 ? slicesAround(local[axis]) : offset < 0 ? 1u << (sizes[axis] - 1) : 1u;
+    };
+
+    for (int dx = -1; dx <= 1; dx++) {
+        if (!reaches(0, dx)) continue;
+        Chunk* column = dx < 0 ? chunk->neighbours[NEIGHBOUR_NEG_X] : dx > 0 ? chunk->neighbours[NEIGHBOUR_POS_X] : chunk;
+        if (!column) continue;
+        for (int dz = -1; dz <= 1; dz++) {
+            if (!reaches(2, dz)) continue;
+            Chunk* target = dz < 0 ? column->neighbours[NEIGHBOUR_NEG_Z] : dz > 0 ? column->neighbours[NEIGHBOUR_POS_Z] : column;
+            if (!target) continue;
+            for (int dy = -1; dy <= 1; dy++) {
+                int targetSection = sectionIndex + dy;
+                if (!reaches(1, dy) || targetSection < 0 || targetSection >= SECTIONS_PER_CHUNK) continue;
+                target->sections[targetSection].markSlicesDirty(slices(0, dx), slices(1, dy), slices(2, dz), edited);
+            }
+        }
+    }
+}
+
+// Edits go straight into their chunk through a cursor, so a fill stays off the
+// chunk map. Only voxels that really change dirty anything, and dirty flags
+// coalesce, so every affected section is remeshed once on the next update.
+int InfiniteWorld::applyEdits(VoxelEditBatch& batch) {
+    std::vector<std::pair<Chunk*, int>>& touched = batch.touchedSections;
+    touched.clear();
+    batch.changedVoxels.clear();
+    VoxelCursor cursor(*this);
+    int changed = 0;
+
+    for (const VoxelEditBatch::Edit& edit : batch.edits) {
+        if (edit.y < 0 || edit.y >= CHUNK_HEIGHT) continue;
+        Chunk* chunk = cursor.getChunk(edit.x, edit.z);
+        if (!chunk) continue; // Chunk not loaded
+
+        int localX = worldToLocal(edit.x);
+        int localZ = worldToLocal(edit.z);
+        if (chunk->getVoxel(localX, edit.y, localZ) == edit.type) continue;
+
+        chunk->setVoxel(localX, edit.y, localZ, edit.type);
+        markVoxelDirty(chunk, localX, edit.y, localZ);
+        int sectionIndex = edit.y / SECTION_SIZE;
+        if (touched.empty() || touched.back().first != chunk || touched.back().second != sectionIndex) {
+            touched.emplace_back(chunk, sectionIndex);
+        }
+        batch.changedVoxels.emplace_back(edit.x, edit.y, edit.z);
+        changed++;
+    }
+    relightVoxels(batch.changedVoxels.data(), batch.changedVoxels.size());
+
+    // Big fills can leave whole sections uniform again
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (auto& [chunk, sectionIndex] : touched) {
+        chunk->sections[sectionIndex].voxels.compact();
+        chunk->needsSave = true;
+    }
+    return changed;
 }
 
     // Mark neighbouring chunks as dirty
 void InfiniteWorld::markNeighbourChunksDirty(ChunkCoord coord) {
-    ChunkCoord neighbours[4] = {
-        ChunkCoord(coord.x - 1, coord.z),
-        ChunkCoord(coord.x + 1, coord.z),
-        ChunkCoord(coord.x, coord.z - 1),
-        ChunkCoord(coord.x, coord.z + 1)
-    };
+    Chunk* chunk = getChunk(coord);
+    if (!chunk) return;
 
-    for (int i = 0; i < 4; i++) {
-        auto it = chunks.find(neighbours[i]);
-        if (it != chunks.end()) {
-            it->second->meshDirty = true;
+    for (Chunk* neighbour : chunk->neighbours) {
+        if (neighbour) {
+            neighbour->markAllSectionsDirty();
         }
     }
 }
@@ -167,9 +918,36 @@ int InfiniteWorld::getLoadedChunkCount() const {
     return chunks.size();
 }
 
+int InfiniteWorld::getPendingChunkCount() const {
+    return pendingChunks.size();
+}
+
+int InfiniteWorld::getRequestedChunkCount() const {
+    return int(loadRequests.size());
+}
+
+int InfiniteWorld::getPendingMeshCount() {
+    int count = 0;
+    for (auto& [coord, chunk] : chunks) {
+        for (const ChunkSection& section : chunk->sections) {
+            if (section.meshJobId != 0 || (section.meshDirty && !section.isEmpty())) count++;
+        }
+    }
+    return count;
+}
+
+bool InfiniteWorld::isAreaLoaded(ChunkCoord center, int radius) {
+    for (int x = center.x - radius; x <= center.x + radius; x++) {
+        for (int z = center.z - radius; z <= center.z + radius; z++) {
+            if (!getChunk(ChunkCoord(x, z))) return false;
+        }
+    }
+    return true;
+}
+
 VoxelType InfiniteWorld::getVoxelTypeAt(int worldX, int worldY, int worldZ) {
-    int chunkX = (int)floor((float)worldX / CHUNK_SIZE);
-    int chunkZ = (int)floor((float)worldZ / CHUNK_SIZE);
+    int chunkX = worldToChunk(worldX);
+    int chunkZ = worldToChunk(worldZ);
 
     ChunkCoord coord(chunkX, chunkZ);
     auto it = chunks.find(coord);
@@ -186,9 +964,9 @@ VoxelType InfiniteWorld::getVoxelTypeAt(int worldX, int worldY, int worldZ) {
         return AIR;
     }
 
-    int localX = worldX - (chunkX * CHUNK_SIZE);
+    int localX = worldToLocal(worldX);
     int localY = worldY;
-    int localZ = worldZ - (chunkZ * CHUNK_SIZE);
+    int localZ = worldToLocal(worldZ);
 
     if (localX < 0 || localX >= CHUNK_SIZE ||
         localY < 0 || localY >= CHUNK_HEIGHT ||
@@ -198,6 +976,143 @@ VoxelType InfiniteWorld::getVoxelTypeAt(int worldX, int worldY, int worldZ) {
         return AIR;
     }
 
-    return chunk->voxels[localX][localY][localZ].isActive ?
-           chunk->voxels[localX][localY][localZ].type : AIR;
-}
\ No newline at end of file
+    return chunk->getVoxel(localX, localY, localZ);
+}
+void VoxelCursor::moveTo(ChunkCoord target) {
+    if (valid && chunk) {
+        int dx = target.x - coord.x;
+        int dz = target.z - coord.z;
+        if (abs(dx) + abs(dz) == 1) {
+            int index = dx < 0 ? NEIGHBOUR_NEG_X : dx > 0 ? NEIGHBOUR_POS_X : dz < 0 ? NEIGHBOUR_NEG_Z : NEIGHBOUR_POS_Z;
+            if (Chunk* neighbour = chunk->neighbours[index]) {
+                chunk = neighbour;
+                coord = target;
+                return;
+            }
+        }
+    }
+    chunk = world.getChunk(target);
+    coord = target;
+    valid = true;
+}
+
+// Amanatides & Woo: step to whichever voxel boundary the ray crosses next,
+// so every voxel along the ray is visited exactly once
+bool InfiniteWorld::raycast(const vec3& origin, const vec3& direction, float maxDistance, RaycastHit& hit) {
+    float length = glm::length(direction);
+    if (length == 0.0f) return false;
+    vec3 dir = direction / length;
+
+    glm::ivec3 voxel(glm::floor(origin));
+    glm::ivec3 step(0);
+    vec3 tMax(INFINITY);
+    vec3 tDelta(INFINITY);
+    for (int axis = 0; axis < 3; axis++) {
+        if (dir[axis] > 0.0f) {
+            step[axis] = 1;
+            tDelta[axis] = 1.0f / dir[axis];
+            tMax[axis] = (float(voxel[axis] + 1) - origin[axis]) * tDelta[axis];
+        } else if (dir[axis] < 0.0f) {
+            step[axis] = -1;
+            tDelta[axis] = -1.0f / dir[axis];
+            tMax[axis] = (origin[axis] - float(voxel[axis])) * tDelta[axis];
+        }
+    }
+
+    VoxelCursor cursor(*this);
+    glm::ivec3 normal(0);
+    float distance = 0.0f;
+    while (true) {
+        VoxelType type = cursor.get(voxel.x, voxel.y, voxel.z);
+        if (isSolidVoxel(type)) {
+            hit.voxel = voxel;
+            hit.normal = normal;
+            hit.type = type;
+            hit.distance = distance;
+            return true;
+        }
+
+        int axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+        distance = tMax[axis];
+        if (distance > maxDistance) return false;
+        voxel[axis] += step[axis];
+        tMax[axis] += tDelta[axis];
+        normal = glm::ivec3(0);
+        normal[axis] = -step[axis];
+
+        // Nothing left to hit once the ray leaves the world vertically
+        if ((voxel.y < 0 && step.y <= 0) || (voxel.y >= CHUNK_HEIGHT && step.y >= 0)) return false;
+    }
+}
+
+// Voxel cells touched by a box, faces that only touch a cell don't count
+static bool voxelRange(const vec3& min, const vec3& max, glm::ivec3& first, glm::ivec3& last) {
+    first = glm::ivec3(glm::floor(min));
+    last = glm::ivec3(glm::ceil(max)) - glm::ivec3(1);
+    first.y = std::max(first.y, 0);
+    last.y = std::min(last.y, CHUNK_HEIGHT - 1);
+    return first.x <= last.x && first.y <= last.y && first.z <= last.z;
+}
+
+static bool boxOverlapsSolid(VoxelCursor& cursor, const vec3& min, const vec3& max) {
+    glm::ivec3 first, last;
+    if (!voxelRange(min, max, first, last)) return false;
+    // y innermost, consecutive lookups stay in one chunk
+    for (int x = first.x; x <= last.x; x++)
+        for (int z = first.z; z <= last.z; z++)
+            for (int y = first.y; y <= last.y; y++)
+                if (isSolidVoxel(cursor.get(x, y, z))) return true;
+    return false;
+}
+
+static bool sphereOverlapsSolid(VoxelCursor& cursor, const vec3& center, float radius) {
+    glm::ivec3 first, last;
+    if (!voxelRange(center - vec3(radius), center + vec3(radius), first, last)) return false;
+    float radiusSquared = radius * radius;
+    for (int x = first.x; x <= last.x; x++) {
+        float dx = std::max(std::max(float(x) - center.x, center.x - float(x + 1)), 0.0f);
+        for (int z = first.z; z <= last.z; z++) {
+            float dz = std::max(std::max(float(z) - center.z, center.z - float(z + 1)), 0.0f);
+            if (dx * dx + dz * dz > radiusSquared) continue;
+            for (int y = first.y; y <= last.y; y++) {
+                float dy = std::max(std::max(float(y) - center.y, center.y - float(y + 1)), 0.0f);
+                if (dx * dx + dy * dy + dz * dz <= radiusSquared && isSolidVoxel(cursor.get(x, y, z))) return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool InfiniteWorld::boxOverlapsSolid(const vec3& min, const vec3& max) {
+    VoxelCursor cursor(*this);
+    return ::boxOverlapsSolid(cursor, min, max);
+}
+
+bool InfiniteWorld::sphereOverlapsSolid(const vec3& center, float radius) {
+    VoxelCursor cursor(*this);
+    return ::sphereOverlapsSolid(cursor, center, radius);
+}
+
+void InfiniteWorld::overlapBoxes(const VoxelBox* boxes, size_t count, bool* results) {
+    VoxelCursor cursor(*this);
+    for (size_t i = 0; i < count; i++) {
+        results[i] = ::boxOverlapsSolid(cursor, boxes[i].min, boxes[i].max);
+    }
+}
+
+void InfiniteWorld::overlapSpheres(const vec4* spheres, size_t count, bool* results) {
+    VoxelCursor cursor(*this);
+    for (size_t i = 0; i < count; i++) {
+        results[i] = ::sphereOverlapsSolid(cursor, vec3(spheres[i]), spheres[i].w);
+    }
+}
+
+void InfiniteWorld::collectSolidVoxels(const vec3& min, const vec3& max, std::vector<glm::ivec3>& out) {
+    glm::ivec3 first, last;
+    if (!voxelRange(min, max, first, last)) return;
+    VoxelCursor cursor(*this);
+    for (int x = first.x; x <= last.x; x++)
+        for (int z = first.z; z <= last.z; z++)
+            for (int y = first.y; y <= last.y; y++)
+                if (isSolidVoxel(cursor.get(x, y, z))) out.push_back(glm::ivec3(x, y, z));
+}
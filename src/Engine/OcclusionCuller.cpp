@@ -0,0 +1,265 @@
+#include "Engine/OcclusionCuller.h"
+#include <GL/glew.h>
+
+static const char* copyShaderSource = R"(
+#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+layout(binding = 0) uniform sampler2D depthTexture;
+layout(r32f, binding = 0) uniform writeonly image2D level0;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, imageSize(level0)))) return;
+    imageStore(level0, texel, vec4(texelFetch(depthTexture, texel, 0).r));
+}
+)";
+
+// Each texel keeps the farthest depth of the texels it covers, odd sizes
+// fold the extra row/column into the last texel so nothing is lost
+static const char* reduceShaderSource = R"(
+#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+layout(r32f, binding = 0) uniform readonly image2D source;
+layout(r32f, binding = 1) uniform writeonly image2D destination;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 destinationSize = imageSize(destination);
+    if (any(greaterThanEqual(texel, destinationSize))) return;
+
+    ivec2 sourceSize = imageSize(source);
+    ivec2 base = texel * 2;
+    ivec2 last = min(base + 1 + ivec2(equal(texel, destinationSize - 1)) * (sourceSize & 1), sourceSize - 1);
+    float depth = 0.0;
+    for (int y = base.y; y <= last.y; y++)
+        for (int x = base.x; x <= last.x; x++)
+            depth = max(depth, imageLoad(source, ivec2(x, y)).r);
+    imageStore(destination, texel, vec4(depth));
+}
+)";
+
+static const char* cullShaderSource = R"(
+#version 430 core
+layout(local_size_x = 64) in;
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+layout(std430, binding = 0) buffer Commands { DrawCommand commands[]; };
+layout(std430, binding = 1) readonly buffer Origins { float origins[]; };
+layout(std430, binding = 2) buffer Counter { uint occluded; };
+layout(binding = 0) uniform sampler2D pyramid;
+
+uniform mat4 viewProj;
+uniform int drawCount;
+uniform vec3 boxSize;
+uniform int levels;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(drawCount)) return;
+
+    uint origin = commands[index].baseInstance * 3u;
+    vec3 boxMin = vec3(origins[origin], origins[origin + 1u], origins[origin + 2u]);
+
+    // Screen rectangle and nearest depth of the box
+    vec2 minUV = vec2(1.0);
+    vec2 maxUV = vec2(0.0);
+    float nearest = 1.0;
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = boxMin + boxSize * vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+        vec4 clip = viewProj * vec4(corner, 1.0);
+        // Crosses the near plane, can't be projected conservatively
+        if (clip.w <= 0.0) {
+            commands[index].instanceCount = 1u;
+            return;
+        }
+        vec3 ndc = clip.xyz / clip.w;
+        vec2 uv = ndc.xy * 0.5 + 0.5;
+        minUV = min(minUV, uv);
+        maxUV = max(maxUV, uv);
+        nearest = min(nearest, ndc.z * 0.5 + 0.5);
+    }
+    minUV = clamp(minUV, 0.0, 1.0);
+    maxUV = clamp(maxUV, 0.0, 1.0);
+
+    // The mip where the rectangle spans at most 2x2 texels
+    vec2 size = (maxUV - minUV) * vec2(textureSize(pyramid, 0));
+    int level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0)))), 0, levels - 1);
+    ivec2 levelSize = textureSize(pyramid, level);
+    ivec2 low = clamp(ivec2(minUV * vec2(levelSize)), ivec2(0), levelSize - 1);
+    ivec2 high = clamp(ivec2(maxUV * vec2(levelSize)), ivec2(0), levelSize - 1);
+    float farthest = max(max(texelFetch(pyramid, low, level).r, texelFetch(pyramid, ivec2(high.x, low.y), level).r),
+                         max(texelFetch(pyramid, ivec2(low.x, high.y), level).r, texelFetch(pyramid, high, level).r));
+
+    bool visible = nearest <= farthest;
+    commands[index].instanceCount = visible ? 1u : 0u;
+    if (!visible) atomicAdd(occluded, 1u);
+}
+)";
+
+static GLuint compileComputeProgram(const char* source) {
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Compute Shader Compilation Failed:\n" << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glDeleteShader(shader);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Compute Program Linking Failed:\n" << infoLog << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+OcclusionCuller::OcclusionCuller()
+    : initialized(false), supported(false), hasDepth(false), width(0), height(0), levels(0),
+      depthViewProj(1.0f), depthTexture(0), pyramidTexture(0), copyProgram(0), reduceProgram(0),
+      cullProgram(0), counterBuffers{}, counterPending{}, counterIndex(0), occludedCount(0) {}
+
+OcclusionCuller::~OcclusionCuller() {
+    if (!initialized) return;
+    glDeleteTextures(1, &depthTexture);
+    glDeleteTextures(1, &pyramidTexture);
+    glDeleteProgram(copyProgram);
+    glDeleteProgram(reduceProgram);
+    glDeleteProgram(cullProgram);
+    glDeleteBuffers(COUNTER_BUFFERS, counterBuffers);
+}
+
+bool OcclusionCuller::init() {
+    initialized = true;
+    copyProgram = compileComputeProgram(copyShaderSource);
+    reduceProgram = compileComputeProgram(reduceShaderSource);
+    cullProgram = compileComputeProgram(cullShaderSource);
+    supported = copyProgram && reduceProgram && cullProgram;
+
+    glGenBuffers(COUNTER_BUFFERS, counterBuffers);
+    for (GLuint buffer : counterBuffers) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_READ);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return supported;
+}
+
+bool OcclusionCuller::isSupported() {
+    if (!initialized) init();
+    return supported;
+}
+
+void OcclusionCuller::resize(int newWidth, int newHeight) {
+    if (depthTexture) glDeleteTextures(1, &depthTexture);
+    if (pyramidTexture) glDeleteTextures(1, &pyramidTexture);
+    width = newWidth;
+    height = newHeight;
+    levels = 1;
+    while ((std::max(width, height) >> levels) > 0) levels++;
+
+    glGenTextures(1, &depthTexture);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenTextures(1, &pyramidTexture);
+    glBindTexture(GL_TEXTURE_2D, pyramidTexture);
+    glTexStorage2D(GL_TEXTURE_2D, levels, GL_R32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    hasDepth = false;
+}
+
+void OcclusionCuller::captureDepth(const mat4& viewProj) {
+    if (!isSupported()) return;
+    // We get called in the middle of the world pass, leave its program bound
+    GLint previousProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (viewport[2] <= 0 || viewport[3] <= 0) return;
+    if (viewport[2] != width || viewport[3] != height) resize(viewport[2], viewport[3]);
+
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, viewport[0], viewport[1], width, height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glUseProgram(copyProgram);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glBindImageTexture(0, pyramidTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+
+    glUseProgram(reduceProgram);
+    for (int level = 1; level < levels; level++) {
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        int levelWidth = std::max(width >> level, 1);
+        int levelHeight = std::max(height >> level, 1);
+        glBindImageTexture(0, pyramidTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+    }
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(previousProgram);
+
+    depthViewProj = viewProj;
+    hasDepth = true;
+}
+
+void OcclusionCuller::cull(GLuint indirectBuffer, GLuint originBuffer, int drawCount) {
+    if (!isSupported() || !hasDepth || drawCount == 0) return;
+    GLint previousProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+
+    // The oldest counter was written COUNTER_BUFFERS frames ago, safe to read back
+    GLuint counter = counterBuffers[counterIndex];
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counter);
+    if (counterPending[counterIndex]) {
+        GLuint occluded = 0;
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &occluded);
+        occludedCount = int(occluded);
+    }
+    GLuint zero = 0;
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+    counterPending[counterIndex] = true;
+    counterIndex = (counterIndex + 1) % COUNTER_BUFFERS;
+
+    glUseProgram(cullProgram);
+    glUniformMatrix4fv(glGetUniformLocation(cullProgram, "viewProj"), 1, GL_FALSE, &depthViewProj[0][0]);
+    glUniform1i(glGetUniformLocation(cullProgram, "drawCount"), drawCount);
+    glUniform3f(glGetUniformLocation(cullProgram, "boxSize"), float(CHUNK_SIZE), float(SECTION_SIZE), float(CHUNK_SIZE));
+    glUniform1i(glGetUniformLocation(cullProgram, "levels"), levels);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, pyramidTexture);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, indirectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, originBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, counter);
+    glDispatchCompute((drawCount + 63) / 64, 1, 1);
+
+    // The draw reads the commands we just wrote
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(previousProgram);
+}
@@ -0,0 +1,151 @@
+#include "Engine/Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+static const char* scopeNames[PROFILE_SCOPE_COUNT] = {
+    "World update",
+    "Terrain generation",
+    "Meshing",
+    "Mesh upload",
+    "Render"
+};
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+const char* Profiler::getScopeName(ProfileScope scope) {
+    return scopeNames[scope];
+}
+
+Profiler::Profiler()
+    : gpuTime(0.0f), frameHistory{}, historyIndex(0), historyCount(0), captureFramesLeft(0) {
+    startTime = std::chrono::steady_clock::now();
+    frameStart = startTime;
+    for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+        scopeNanoseconds[i] = 0;
+        scopeCounts[i] = 0;
+        lastScopeTimes[i] = 0.0f;
+        lastScopeCounts[i] = 0;
+    }
+}
+
+void Profiler::beginFrame() {
+    frameStart = std::chrono::steady_clock::now();
+    counters = FrameCounters();
+}
+
+void Profiler::endFrame() {
+    auto now = std::chrono::steady_clock::now();
+    float frameTime = std::chrono::duration<float, std::milli>(now - frameStart).count();
+    frameHistory[historyIndex] = frameTime;
+    historyIndex = (historyIndex + 1) % HISTORY_SIZE;
+    historyCount = std::min(historyCount + 1, HISTORY_SIZE);
+
+    for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+        lastScopeTimes[i] = scopeNanoseconds[i].exchange(0) / 1e6f;
+        lastScopeCounts[i] = scopeCounts[i].exchange(0);
+    }
+    lastCounters = counters;
+
+    if (captureFramesLeft > 0 && --captureFramesLeft == 0) {
+        writeTrace();
+    }
+}
+
+void Profiler::addScopeTime(ProfileScope scope, std::chrono::steady_clock::time_point start,
+                            std::chrono::steady_clock::time_point end) {
+    scopeNanoseconds[scope] += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    scopeCounts[scope]++;
+
+    if (captureFramesLeft > 0) {
+        TraceEvent event;
+        event.scope = scope;
+        event.thread = unsigned(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xffff);
+        event.start = std::chrono::duration_cast<std::chrono::microseconds>(start - startTime).count();
+        event.duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        std::lock_guard<std::mutex> lock(traceMutex);
+        traceEvents.push_back(event);
+    }
+}
+
+float Profiler::getFramePercentile(float percentile) const {
+    if (historyCount == 0) return 0.0f;
+    std::vector<float> sorted(frameHistory, frameHistory + historyCount);
+    size_t index = std::min(sorted.size() - 1, size_t(percentile / 100.0f * sorted.size()));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+void Profiler::captureTrace(int frames, const std::string& path) {
+    if (isCapturing() || frames <= 0) return;
+    {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        traceEvents.clear();
+    }
+    capturePath = path;
+    captureFramesLeft = frames;
+}
+
+// Chrome trace event format, one complete ("X") event per scope
+void Profiler::writeTrace() {
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        events.swap(traceEvents);
+    }
+
+    std::ofstream file(capturePath);
+    if (!file) {
+        std::cerr << "Failed to write trace to " << capturePath << "\n";
+        return;
+    }
+    file << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); i++) {
+        const TraceEvent& event = events[i];
+        file << "{\"name\":\"" << scopeNames[event.scope] << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+             << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}"
+             << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+    std::cout << "Wrote " << events.size() << " trace events to " << capturePath << "\n";
+}
+
+GpuTimer::GpuTimer() : initialized(false), queries{}, pending{}, current(0), lastTime(0.0f) {}
+
+GpuTimer::~GpuTimer() {
+    if (initialized) glDeleteQueries(QUERY_COUNT, queries);
+}
+
+void GpuTimer::init() {
+    initialized = true;
+    glGenQueries(QUERY_COUNT, queries);
+}
+
+void GpuTimer::begin() {
+    if (!initialized) init();
+
+    // The slot we're about to reuse was issued QUERY_COUNT frames ago, pick up its result first
+    if (pending[current]) {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &elapsed);
+            lastTime = elapsed / 1e6f;
+        }
+        // Still not done after a few frames: drop it rather than stall
+        pending[current] = false;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+}
+
+void GpuTimer::end() {
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[current] = true;
+    current = (current + 1) % QUERY_COUNT;
+}
@@ -0,0 +1,226 @@
+#include "Engine/RegionFile.h"
+#include "Engine/Chunk.h"
+#include <cstring>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+RegionFile::RegionFile(const std::string& path)
+    : path(path), file(nullptr), entries{}, mapped(nullptr), mappedSize(0) {
+    file = std::fopen(path.c_str(), "r+b");
+    if (file) {
+        if (!readHeader()) {
+            std::cerr << "Corrupt region file " << path << ", ignoring it\n";
+            std::fclose(file);
+            file = nullptr;
+        }
+        return;
+    }
+    file = std::fopen(path.c_str(), "w+b");
+    if (file && !writeHeader()) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+RegionFile::~RegionFile() {
+    unmap();
+    if (file) std::fclose(file);
+}
+
+bool RegionFile::readHeader() {
+    uint32_t header[2];
+    if (std::fseek(file, 0, SEEK_SET) != 0 ||
+        std::fread(header, sizeof(header), 1, file) != 1 ||
+        header[0] != MAGIC || header[1] != VERSION) {
+        return false;
+    }
+    return std::fread(entries, sizeof(entries), 1, file) == 1;
+}
+
+bool RegionFile::writeHeader() {
+    uint32_t header[2] = { MAGIC, VERSION };
+    bool ok = std::fseek(file, 0, SEEK_SET) == 0 &&
+              std::fwrite(header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(entries, sizeof(entries), 1, file) == 1;
+    return ok && std::fflush(file) == 0;
+}
+
+bool RegionFile::has(int localX, int localZ) const {
+    return entries[localZ * REGION_CHUNKS + localX].size != 0;
+}
+
+void RegionFile::unmap() {
+#ifndef _WIN32
+    if (mapped) munmap(const_cast<uint8_t*>(mapped), mappedSize);
+#endif
+    mapped = nullptr;
+    mappedSize = 0;
+}
+
+// Remaps the whole file once a read goes past the end of the current mapping
+bool RegionFile::ensureMapped(size_t size) {
+#ifndef _WIN32
+    if (mapped && mappedSize >= size) return true;
+    unmap();
+    if (std::fseek(file, 0, SEEK_END) != 0) return false;
+    long fileSize = std::ftell(file);
+    if (fileSize < 0 || size_t(fileSize) < size) return false;
+
+    void* pointer = mmap(nullptr, size_t(fileSize), PROT_READ, MAP_SHARED, fileno(file), 0);
+    if (pointer == MAP_FAILED) return false;
+    mapped = static_cast<const uint8_t*>(pointer);
+    mappedSize = size_t(fileSize);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool RegionFile::read(int localX, int localZ, std::vector<uint8_t>& out) {
+    const Entry& entry = entries[localZ * REGION_CHUNKS + localX];
+    if (!file || entry.size == 0) return false;
+
+    out.resize(entry.size);
+    if (ensureMapped(size_t(entry.offset) + entry.size)) {
+        std::memcpy(out.data(), mapped + entry.offset, entry.size);
+        return true;
+    }
+    return std::fseek(file, long(entry.offset), SEEK_SET) == 0 &&
+           std::fread(out.data(), entry.size, 1, file) == 1;
+}
+
+bool RegionFile::write(int localX, int localZ, const std::vector<uint8_t>& payload) {
+    if (!file || payload.empty()) return false;
+    int index = localZ * REGION_CHUNKS + localX;
+    Entry entry = entries[index];
+
+    // Shrinking or same-size rewrites stay in place, anything bigger is appended
+    if (entry.size == 0 || payload.size() > entry.size) {
+        if (std::fseek(file, 0, SEEK_END) != 0) return false;
+        entry.offset = uint32_t(std::ftell(file));
+    } else if (std::fseek(file, long(entry.offset), SEEK_SET) != 0) {
+        return false;
+    }
+    entry.size = uint32_t(payload.size());
+    if (std::fwrite(payload.data(), payload.size(), 1, file) != 1) return false;
+
+    long entryPosition = 8 + long(index * sizeof(Entry));
+    if (std::fseek(file, entryPosition, SEEK_SET) != 0 ||
+        std::fwrite(&entry, sizeof(Entry), 1, file) != 1 ||
+        std::fflush(file) != 0) {
+        return false;
+    }
+    entries[index] = entry;
+    return true;
+}
+
+ChunkStorage::ChunkStorage(const std::string& directory) : directory(directory), writer(1) {}
+
+ChunkStorage::~ChunkStorage() {
+    flush();
+    writer.shutdown();
+    for (auto& [coord, region] : regions) {
+        delete region;
+    }
+}
+
+std::string ChunkStorage::directoryForSeed(unsigned int seed) {
+    return "saves/" + std::to_string(seed);
+}
+
+std::string ChunkStorage::regionPath(ChunkCoord regionCoord) const {
+    return directory + "/r." + std::to_string(regionCoord.x) + "." + std::to_string(regionCoord.z) + ".vxr";
+}
+
+// A region without a file (cached) means it doesn't exist, reads of unsaved regions stay cheap
+ChunkStorage::Region* ChunkStorage::getRegion(ChunkCoord regionCoord) {
+    auto it = regions.find(regionCoord);
+    if (it != regions.end()) return it->second;
+
+    std::string path = regionPath(regionCoord);
+    Region* region = new Region();
+    if (std::filesystem::exists(path)) {
+        region->file.reset(new RegionFile(path));
+    }
+    regions[regionCoord] = region;
+    return region;
+}
+
+bool ChunkStorage::loadChunk(ChunkCoord coord, Chunk& chunk) {
+    ChunkCoord regionCoord(floorDiv(coord.x, REGION_CHUNKS), floorDiv(coord.z, REGION_CHUNKS));
+    std::vector<uint8_t> payload;
+    Region* region;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto pending = pendingWrites.find(coord);
+        if (pending != pendingWrites.end()) {
+            payload = *pending->second;
+            return chunk.deserialize(payload);
+        }
+        region = getRegion(regionCoord);
+    }
+    {
+        // Not queued, so any write of this chunk has already hit the file
+        std::lock_guard<std::mutex> lock(region->mutex);
+        if (!region->file || !region->file->read(coord.x - regionCoord.x * REGION_CHUNKS,
+                                                 coord.z - regionCoord.z * REGION_CHUNKS, payload)) {
+            return false;
+        }
+    }
+    return chunk.deserialize(payload);
+}
+
+void ChunkStorage::saveChunkAsync(ChunkCoord coord, std::vector<uint8_t> payload) {
+    Payload shared = std::make_shared<const std::vector<uint8_t>>(std::move(payload));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingWrites[coord] = shared;
+    }
+    writer.submit([this, coord, shared]() { writePending(coord, shared); });
+}
+
+void ChunkStorage::writePending(ChunkCoord coord, Payload payload) {
+    ChunkCoord regionCoord(floorDiv(coord.x, REGION_CHUNKS), floorDiv(coord.z, REGION_CHUNKS));
+    Region* region;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        region = getRegion(regionCoord);
+    }
+    {
+        std::lock_guard<std::mutex> lock(region->mutex);
+        if (!region->file) {
+            // The save directory only appears once something is written to it
+            std::error_code error;
+            std::filesystem::create_directories(directory, error);
+            if (error) {
+                std::cerr << "Failed to create save directory " << directory << ": " << error.message() << "\n";
+            }
+            region->file.reset(new RegionFile(regionPath(regionCoord)));
+        }
+        if (!region->file->write(coord.x - regionCoord.x * REGION_CHUNKS, coord.z - regionCoord.z * REGION_CHUNKS,
+                                 *payload)) {
+            std::cerr << "Failed to save chunk (" << coord.x << ", " << coord.z << ")\n";
+        }
+    }
+
+    // A newer save of the same chunk may have been queued behind us
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pendingWrites.find(coord);
+    if (it != pendingWrites.end() && it->second == payload) {
+        pendingWrites.erase(it);
+    }
+    if (pendingWrites.empty()) writesDone.notify_all();
+}
+
+void ChunkStorage::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    writesDone.wait(lock, [this]() { return pendingWrites.empty(); });
+}
+
+size_t ChunkStorage::getPendingWriteCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingWrites.size();
+}
@@ -0,0 +1,140 @@
+#include "Engine/Registry.h"
+#include "Engine/Lighting.h"
+#include "Generation/Biomes.h"
+#include <cstdio>
+#include <cstring>
+
+static const char* const VOXEL_NAMES[VOXEL_TYPE_COUNT] = {
+    "air", "stone", "grass", "dirt", "sand", "water", "snow", "log", "leaves", "lamp"
+};
+
+// The same as assets/registry.cfg, used until it loads (and by VoxelBench)
+static const BlockDefinition BUILTIN_BLOCKS[VOXEL_TYPE_COUNT] = {
+    {AIR,    false, false, false, 0,         vec3(1.0f, 1.0f, 1.0f)},
+    {STONE,  true,  false, true,  0,         vec3(0.5f, 0.5f, 0.5f)},
+    {GRASS,  true,  false, true,  0,         vec3(0.0f, 0.8f, 0.0f)},
+    {DIRT,   true,  false, true,  0,         vec3(0.6f, 0.4f, 0.2f)},
+    {SAND,   true,  false, true,  0,         vec3(0.9f, 0.8f, 0.5f)},
+    {WATER,  false, true,  false, 0,         vec3(0.2f, 0.4f, 0.8f)},
+    {SNOW,   true,  false, true,  0,         vec3(0.95f, 0.98f, 1.0f)},
+    {LOG,    true,  false, true,  0,         vec3(0.55f, 0.27f, 0.07f)},
+    {LEAVES, true,  true,  true,  0,         vec3(0.13f, 0.55f, 0.13f)},
+    {LAMP,   true,  false, true,  MAX_LIGHT, vec3(1.0f, 0.85f, 0.45f)}
+};
+
+BlockTable BLOCK_TABLE = compileBlockTable(BUILTIN_BLOCKS, VOXEL_TYPE_COUNT);
+
+const char* getVoxelName(VoxelType type) {
+    return type < VOXEL_TYPE_COUNT ? VOXEL_NAMES[type] : "unknown";
+}
+
+bool voxelTypeFromName(const char* name, VoxelType& type) {
+    for (int i = 0; i < VOXEL_TYPE_COUNT; i++) {
+        if (std::strcmp(name, VOXEL_NAMES[i]) == 0) {
+            type = VoxelType(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Bytes that aren't a voxel type read as empty air
+BlockTable compileBlockTable(const BlockDefinition* definitions, int count) {
+    BlockTable table;
+    std::fill_n(table.flags, 256, uint8_t(0));
+    std::fill_n(table.emission, 256, uint8_t(0));
+    std::fill_n(table.color, 256, vec3(1.0f));
+    for (int i = 0; i < count; i++) {
+        const BlockDefinition& block = definitions[i];
+        table.flags[block.type] = uint8_t((block.solid ? BLOCK_SOLID : 0) | (block.translucent ? BLOCK_TRANSLUCENT : 0) |
+                                          (block.opaque ? BLOCK_OPAQUE : 0));
+        table.emission[block.type] = uint8_t(block.emission);
+        table.color[block.type] = block.color;
+    }
+    return table;
+}
+
+// One definition per line, '#' starts a comment:
+//   block NAME SOLID TRANSLUCENT OPAQUE EMISSION R G B
+//   biome NAME SURFACE SUBSURFACE FILLER BASE_HEIGHT HEIGHT_VARIATION TREES WATER
+// Blocks override the built in type of that name. Biomes replace the built in
+// list, in order, so the file has to name at least one.
+static bool parseBlock(const char* line, BlockDefinition& block) {
+    char name[32];
+    int solid, translucent, opaque;
+    if (std::sscanf(line, "block %31s %d %d %d %d %f %f %f", name, &solid, &translucent, &opaque, &block.emission,
+                    &block.color.r, &block.color.g, &block.color.b) != 8 ||
+        !voxelTypeFromName(name, block.type)) {
+        return false;
+    }
+    block.solid = solid != 0;
+    block.translucent = translucent != 0;
+    block.opaque = opaque != 0;
+    // Air has to stay empty, the rest of the engine relies on it
+    if (block.type == AIR && (block.solid || block.translucent || block.opaque)) return false;
+    return block.emission >= 0 && block.emission <= MAX_LIGHT;
+}
+
+static bool parseBiome(const char* line, Biome& biome) {
+    char name[32], surface[32], subsurface[32], filler[32];
+    int trees, water;
+    if (std::sscanf(line, "biome %31s %31s %31s %31s %f %f %d %d", name, surface, subsurface, filler,
+                    &biome.baseHeight, &biome.heightVariation, &trees, &water) != 8 ||
+        !voxelTypeFromName(surface, biome.surface) || !voxelTypeFromName(subsurface, biome.subsurface) ||
+        !voxelTypeFromName(filler, biome.filler)) {
+        return false;
+    }
+    biome.name = name;
+    biome.trees = trees != 0;
+    biome.water = water != 0;
+    return true;
+}
+
+bool loadRegistry(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "r");
+    if (!file) {
+        std::cerr << "Failed to open registry " << path << ", using the built in blocks and biomes\n";
+        return false;
+    }
+
+    BlockDefinition blocks[VOXEL_TYPE_COUNT];
+    std::copy(BUILTIN_BLOCKS, BUILTIN_BLOCKS + VOXEL_TYPE_COUNT, blocks);
+    std::vector<Biome> biomes;
+    char line[256];
+    int lineNumber = 0;
+    bool ok = true;
+    while (std::fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        const char* start = line;
+        while (*start == ' ' || *start == '\t') start++;
+        if (*start == '#' || *start == '\n' || *start == '\r' || *start == '\0') continue;
+
+        if (std::strncmp(start, "block ", 6) == 0) {
+            BlockDefinition block;
+            ok = parseBlock(start, block);
+            if (ok) blocks[block.type] = block;
+        } else if (std::strncmp(start, "biome ", 6) == 0) {
+            Biome biome;
+            ok = parseBiome(start, biome);
+            if (ok) biomes.push_back(biome);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Bad definition in " << path << " on line " << lineNumber << "\n";
+            break;
+        }
+    }
+    std::fclose(file);
+
+    // Columns store their biome in a byte, see ColumnInfo
+    if (ok && (biomes.empty() || biomes.size() > 255)) {
+        std::cerr << "Registry " << path << " needs between 1 and 255 biomes\n";
+        ok = false;
+    }
+    if (!ok) return false;
+
+    BLOCK_TABLE = compileBlockTable(blocks, VOXEL_TYPE_COUNT);
+    setBiomes(std::move(biomes));
+    return true;
+}
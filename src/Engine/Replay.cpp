@@ -0,0 +1,158 @@
+#include "Engine/Replay.h"
+#include "Engine/Camera.h"
+
+bool CameraPath::load(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "r");
+    if (!file) {
+        std::cerr << "Failed to open camera path " << path << "\n";
+        return false;
+    }
+
+    keyframes.clear();
+    char line[256];
+    int lineNumber = 0;
+    bool ok = true;
+    while (std::fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        const char* start = line;
+        while (*start == ' ' || *start == '\t') start++;
+        if (*start == '#' || *start == '\n' || *start == '\r' || *start == '\0') continue;
+
+        CameraKeyframe keyframe;
+        if (std::sscanf(start, "%f %f %f %f %f %f", &keyframe.time, &keyframe.position.x, &keyframe.position.y,
+                        &keyframe.position.z, &keyframe.yaw, &keyframe.pitch) != 6 ||
+            (!keyframes.empty() && keyframe.time < keyframes.back().time)) {
+            std::cerr << "Bad keyframe in " << path << " on line " << lineNumber << "\n";
+            ok = false;
+            break;
+        }
+        keyframes.push_back(keyframe);
+    }
+    std::fclose(file);
+
+    if (ok && keyframes.empty()) {
+        std::cerr << "Camera path " << path << " has no keyframes\n";
+        ok = false;
+    }
+    if (!ok) keyframes.clear();
+    return ok;
+}
+
+bool CameraPath::save(const std::string& path) const {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "Failed to write camera path " << path << "\n";
+        return false;
+    }
+    std::fprintf(file, "# time x y z yaw pitch\n");
+    for (const CameraKeyframe& keyframe : keyframes) {
+        std::fprintf(file, "%.4f %.3f %.3f %.3f %.3f %.3f\n", keyframe.time, keyframe.position.x,
+                     keyframe.position.y, keyframe.position.z, keyframe.yaw, keyframe.pitch);
+    }
+    std::fclose(file);
+    return true;
+}
+
+void CameraPath::addKeyframe(float time, const Camera& camera) {
+    keyframes.push_back({time, camera.position, camera.yaw, camera.pitch});
+}
+
+bool CameraPath::apply(float time, Camera& camera) const {
+    if (keyframes.empty() || time > getDuration()) return false;
+
+    // First keyframe after `time`, paths are short enough for a binary search to be plenty
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+                                 [](float t, const CameraKeyframe& keyframe) { return t < keyframe.time; });
+    if (next == keyframes.begin() || next == keyframes.end()) {
+        const CameraKeyframe& keyframe = next == keyframes.end() ? keyframes.back() : keyframes.front();
+        camera.position = keyframe.position;
+        camera.setOrientation(keyframe.yaw, keyframe.pitch);
+        return true;
+    }
+
+    const CameraKeyframe& a = *(next - 1);
+    const CameraKeyframe& b = *next;
+    float span = b.time - a.time;
+    float t = span > 0.0f ? (time - a.time) / span : 1.0f;
+    camera.position = glm::mix(a.position, b.position, t);
+    camera.setOrientation(a.yaw + (b.yaw - a.yaw) * t, a.pitch + (b.pitch - a.pitch) * t);
+    return true;
+}
+
+CameraPath CameraPath::standardRoute() {
+    const float side = 1600.0f;
+    const float speed = 100.0f;
+    const float turnTime = 0.5f;
+    const float height = 60.0f;
+    const float pitch = -10.0f;
+    // +X, +Z, -X, -Z legs, yaw 0 looks down +X (see Camera::updateCameraVectors)
+    const vec3 directions[4] = {vec3(1, 0, 0), vec3(0, 0, 1), vec3(-1, 0, 0), vec3(0, 0, -1)};
+    const float yaws[4] = {0.0f, 90.0f, 180.0f, 270.0f};
+
+    CameraPath route;
+    vec3 position(0.5f, height, 0.5f);
+    float time = 0.0f;
+    for (int leg = 0; leg < 4; leg++) {
+        route.keyframes.push_back({time, position, yaws[leg], pitch});
+        position += directions[leg] * side;
+        time += side / speed;
+        route.keyframes.push_back({time, position, yaws[leg], pitch});
+        // Turn on the spot at each corner
+        time += turnTime;
+    }
+    return route;
+}
+
+ReplayLog::~ReplayLog() {
+    close();
+}
+
+bool ReplayLog::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "Failed to write replay log " << path << "\n";
+        return false;
+    }
+    std::fprintf(file, "frame,time,cpu_ms,gpu_ms,update_ms,render_ms,chunks_loaded,meshes_uploaded,draw_calls,triangles\n");
+    return true;
+}
+
+void ReplayLog::addFrame(const ReplayFrame& frame) {
+    frames.push_back(frame);
+    if (!file) return;
+    std::fprintf(file, "%d,%.4f,%.3f,%.3f,%.3f,%.3f,%d,%d,%d,%ld\n", frame.frame, frame.time, frame.cpuTime,
+                 frame.gpuTime, frame.updateTime, frame.renderTime, frame.chunksLoaded, frame.meshesUploaded,
+                 frame.drawCalls, frame.triangles);
+}
+
+void ReplayLog::close() {
+    if (file) std::fclose(file);
+    file = nullptr;
+}
+
+float ReplayLog::getCpuPercentile(float percentile) const {
+    if (frames.empty()) return 0.0f;
+    std::vector<float> times;
+    times.reserve(frames.size());
+    for (const ReplayFrame& frame : frames) times.push_back(frame.cpuTime);
+    size_t index = std::min(times.size() - 1, size_t(percentile / 100.0f * times.size()));
+    std::nth_element(times.begin(), times.begin() + index, times.end());
+    return times[index];
+}
+
+void ReplayLog::printSummary() const {
+    int chunksLoaded = 0;
+    int meshesUploaded = 0;
+    float gpuTotal = 0.0f;
+    for (const ReplayFrame& frame : frames) {
+        chunksLoaded += frame.chunksLoaded;
+        meshesUploaded += frame.meshesUploaded;
+        gpuTotal += frame.gpuTime;
+    }
+    std::cout << "Replay: " << frames.size() << " frames, " << chunksLoaded << " chunks loaded, "
+              << meshesUploaded << " meshes uploaded\n";
+    std::cout << "CPU frame time: p50 " << getCpuPercentile(50.0f) << " ms, p95 " << getCpuPercentile(95.0f)
+              << " ms, p99 " << getCpuPercentile(99.0f) << " ms, max " << getCpuPercentile(100.0f) << " ms\n";
+    std::cout << "GPU frame time: mean " << (frames.empty() ? 0.0f : gpuTotal / frames.size()) << " ms\n";
+}
@@ -0,0 +1,177 @@
+#include "Engine/TextureArray.h"
+#include "Engine/Chunk.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Header of the blob on disk, followed by size * size * layers RGBA8 texels.
+// Written in host byte order, the blob is a build artifact and not meant to travel.
+struct TextureBlobHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t size;
+    uint32_t layers;
+};
+
+static const char TEXTURE_BLOB_MAGIC[4] = {'V', 'X', 'T', 'A'};
+// Bump whenever bake() changes so stale blobs are rebuilt
+constexpr uint32_t TEXTURE_BLOB_VERSION = 2;
+
+bool TextureAtlasData::load(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Failed to open voxel textures " << path << "\n";
+        return false;
+    }
+
+    TextureBlobHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, TEXTURE_BLOB_MAGIC, sizeof(header.magic)) == 0 &&
+              header.version == TEXTURE_BLOB_VERSION && header.size > 0 && header.size <= 1024 &&
+              header.layers == uint32_t(VOXEL_TYPE_COUNT * TEXTURE_FACES);
+    if (ok) {
+        texels.resize(size_t(header.size) * header.size * header.layers * 4);
+        ok = std::fread(texels.data(), 1, texels.size(), file) == texels.size();
+    }
+    std::fclose(file);
+
+    if (!ok) {
+        std::cerr << "Voxel textures " << path << " are malformed or out of date\n";
+        texels.clear();
+        return false;
+    }
+    size = int(header.size);
+    layers = int(header.layers);
+    return true;
+}
+
+bool TextureAtlasData::save(const std::string& path) const {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to write voxel textures " << path << "\n";
+        return false;
+    }
+    TextureBlobHeader header;
+    std::memcpy(header.magic, TEXTURE_BLOB_MAGIC, sizeof(header.magic));
+    header.version = TEXTURE_BLOB_VERSION;
+    header.size = uint32_t(size);
+    header.layers = uint32_t(layers);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(texels.data(), 1, texels.size(), file) == texels.size();
+    std::fclose(file);
+    if (!ok) std::cerr << "Failed to write voxel textures " << path << "\n";
+    return ok;
+}
+
+// Integer hash so the baked textures come out the same everywhere, 0..1
+static float texelNoise(int layer, int x, int y) {
+    uint32_t h = uint32_t(layer) * 374761393u + uint32_t(x) * 668265263u + uint32_t(y) * 2246822519u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    h ^= h >> 16;
+    return float(h & 0xFFFF) / 65535.0f;
+}
+
+// Base color from Chunk::getVoxelColor with a little per texel grain and a
+// few simple patterns so faces read as materials. Only the translucent voxels
+// get any alpha, see isTranslucentVoxel.
+static vec3 bakeTexel(VoxelType type, TextureFace face, int x, int y) {
+    const int size = VOXEL_TEXTURE_SIZE;
+    int layer = textureLayer(type, face);
+    vec3 base = Chunk::getVoxelColor(type);
+    float grain = 0.88f + 0.24f * texelNoise(layer, x, y);
+
+    switch (type) {
+        case GRASS: {
+            vec3 dirt = Chunk::getVoxelColor(DIRT) * grain;
+            if (face == TEXTURE_FACE_TOP) return base * grain;
+            if (face == TEXTURE_FACE_BOTTOM) return dirt;
+            // Grass hangs a ragged two to four texels over the top of the sides
+            int fringe = size - 2 - int(texelNoise(layer, x, -1) * 2.99f);
+            return y >= fringe ? base * grain : dirt;
+        }
+        case LOG: {
+            if (face == TEXTURE_FACE_SIDE) {
+                // Vertical bark grooves
+                return base * grain * ((x % 4 == 0) ? 0.7f : 1.0f);
+            }
+            // Cut ends show growth rings around lighter wood
+            float center = (size - 1) * 0.5f;
+            float ring = std::sqrt((x - center) * (x - center) + (y - center) * (y - center));
+            if (ring > size * 0.5f - 1.0f) return base * grain;
+            return base * grain * ((int(ring) % 3 == 0) ? 1.2f : 1.6f);
+        }
+        case LEAVES:
+            // Dark gaps between the leaves, cut out by bakeAlpha
+            return base * (texelNoise(layer + 1, x, y) < 0.2f ? 0.55f : grain);
+        case LAMP: {
+            bool frame = x == 0 || y == 0 || x == size - 1 || y == size - 1;
+            return frame ? base * 0.5f : glm::min(base * (1.1f + 0.2f * texelNoise(layer, x, y)), vec3(1.0f));
+        }
+        case WATER:
+            return base * (0.92f + 0.08f * std::sin(6.2831853f * (x + y) / size));
+        default:
+            return base * grain;
+    }
+}
+
+// Water is see-through, leaves have holes cut out of them
+static uint8_t bakeAlpha(VoxelType type, TextureFace face, int x, int y) {
+    if (type == WATER) return 160;
+    if (type == LEAVES && texelNoise(textureLayer(type, face) + 1, x, y) < 0.2f) return 0;
+    return 255;
+}
+
+TextureAtlasData TextureAtlasData::bake() {
+    TextureAtlasData atlas;
+    atlas.size = VOXEL_TEXTURE_SIZE;
+    atlas.layers = VOXEL_TYPE_COUNT * TEXTURE_FACES;
+    atlas.texels.resize(size_t(atlas.size) * atlas.size * atlas.layers * 4);
+
+    uint8_t* texel = atlas.texels.data();
+    for (int type = 0; type < VOXEL_TYPE_COUNT; type++) {
+        for (int face = 0; face < TEXTURE_FACES; face++) {
+            for (int y = 0; y < atlas.size; y++) {
+                for (int x = 0; x < atlas.size; x++) {
+                    vec3 color = glm::clamp(bakeTexel(VoxelType(type), TextureFace(face), x, y), vec3(0.0f), vec3(1.0f));
+                    texel[0] = uint8_t(color.r * 255.0f + 0.5f);
+                    texel[1] = uint8_t(color.g * 255.0f + 0.5f);
+                    texel[2] = uint8_t(color.b * 255.0f + 0.5f);
+                    texel[3] = bakeAlpha(VoxelType(type), TextureFace(face), x, y);
+                    texel += 4;
+                }
+            }
+        }
+    }
+    return atlas;
+}
+
+TextureArray::TextureArray() : texture(0) {}
+
+TextureArray::~TextureArray() {
+    if (texture) glDeleteTextures(1, &texture);
+}
+
+void TextureArray::init(const std::string& path) {
+    TextureAtlasData atlas;
+    if (!atlas.load(path)) {
+        std::cerr << "Baking voxel textures in memory, run VoxelEngine --bake-textures " << path << " to keep them\n";
+        atlas = TextureAtlasData::bake();
+    }
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, atlas.size, atlas.size, atlas.layers, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, atlas.texels.data());
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    // Crisp up close, mipmapped in the distance so far terrain doesn't shimmer
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::bind(int unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+}
@@ -0,0 +1,80 @@
+#include "Engine/ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount) : activeCount(0), stopping(false) {
+    setThreadCount(threadCount);
+}
+
+unsigned int ThreadPool::defaultThreadCount() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+void ThreadPool::setThreadCount(unsigned int threadCount) {
+    size_t count = threadCount == 0 ? defaultThreadCount() : threadCount;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping || count == workers.size()) return;
+        activeCount = count;
+    }
+    if (count > workers.size()) {
+        while (workers.size() < count) {
+            workers.emplace_back(&ThreadPool::workerLoop, this, workers.size());
+        }
+        return;
+    }
+    condition.notify_all();
+    while (workers.size() > count) {
+        workers.back().join();
+        workers.pop_back();
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return;
+        jobs.push_back(std::move(job));
+    }
+    condition.notify_one();
+}
+
+void ThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return;
+        stopping = true;
+        jobs.clear();
+    }
+    condition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return workers.size();
+}
+
+size_t ThreadPool::getQueuedJobCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this, index] { return stopping || index >= activeCount || !jobs.empty(); });
+            if (stopping || index >= activeCount) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
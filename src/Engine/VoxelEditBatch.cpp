@@ -0,0 +1,39 @@
+#include "Engine/VoxelEditBatch.h"
+
+void VoxelEditBatch::set(int worldX, int worldY, int worldZ, VoxelType type) {
+    edits.push_back({worldX, worldY, worldZ, type});
+}
+
+void VoxelEditBatch::set(const std::vector<glm::ivec3>& voxels, VoxelType type) {
+    for (const glm::ivec3& voxel : voxels) {
+        edits.push_back({voxel.x, voxel.y, voxel.z, type});
+    }
+}
+
+// y innermost, so consecutive edits stay in one chunk column
+void VoxelEditBatch::fillBox(const glm::ivec3& min, const glm::ivec3& max, VoxelType type) {
+    int minY = std::max(min.y, 0);
+    int maxY = std::min(max.y, CHUNK_HEIGHT - 1);
+    for (int x = min.x; x <= max.x; x++)
+        for (int z = min.z; z <= max.z; z++)
+            for (int y = minY; y <= maxY; y++)
+                edits.push_back({x, y, z, type});
+}
+
+void VoxelEditBatch::fillSphere(const vec3& center, float radius, VoxelType type) {
+    glm::ivec3 min(glm::floor(center - vec3(radius)));
+    glm::ivec3 max(glm::floor(center + vec3(radius)));
+    min.y = std::max(min.y, 0);
+    max.y = std::min(max.y, CHUNK_HEIGHT - 1);
+    float radiusSquared = radius * radius;
+    for (int x = min.x; x <= max.x; x++) {
+        float dx = x + 0.5f - center.x;
+        for (int z = min.z; z <= max.z; z++) {
+            float dz = z + 0.5f - center.z;
+            for (int y = min.y; y <= max.y; y++) {
+                float dy = y + 0.5f - center.y;
+                if (dx * dx + dy * dy + dz * dz <= radiusSquared) edits.push_back({x, y, z, type});
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include "Engine/VoxelStorage.h"
+#include <cstring>
+#include <mutex>
+
+// Frees the spares at exit
+struct SectionBufferPool : std::vector<uint8_t*> {
+    ~SectionBufferPool() {
+        for (uint8_t* buffer : *this) delete[] buffer;
+    }
+};
+
+static std::mutex bufferPoolMutex;
+static SectionBufferPool bufferPool;
+
+uint8_t* VoxelStorage::acquireBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(bufferPoolMutex);
+        if (!bufferPool.empty()) {
+            uint8_t* buffer = bufferPool.back();
+            bufferPool.pop_back();
+            return buffer;
+        }
+    }
+    return new uint8_t[SECTION_VOLUME];
+}
+
+void VoxelStorage::BufferReleaser::operator()(uint8_t* buffer) const {
+    {
+        std::lock_guard<std::mutex> lock(bufferPoolMutex);
+        if (bufferPool.size() < MAX_POOLED_BUFFERS) {
+            if (bufferPool.capacity() == 0) bufferPool.reserve(MAX_POOLED_BUFFERS);
+            bufferPool.push_back(buffer);
+            return;
+        }
+    }
+    delete[] buffer;
+}
+
+size_t VoxelStorage::getPooledBufferCount() {
+    std::lock_guard<std::mutex> lock(bufferPoolMutex);
+    return bufferPool.size();
+}
+
+void VoxelStorage::set(int x, int y, int z, VoxelType type) {
+    if (!data) {
+        if (type == uniformType) return;
+        data.reset(acquireBuffer());
+        std::memset(data.get(), uniformType, SECTION_VOLUME);
+    }
+    data[indexOf(x, y, z)] = uint8_t(type);
+}
+
+void VoxelStorage::fill(VoxelType type) {
+    data.reset();
+    uniformType = type;
+}
+
+bool VoxelStorage::compact() {
+    if (!data) return false;
+    uint8_t first = data[0];
+    for (int i = 1; i < SECTION_VOLUME; i++) {
+        if (data[i] != first) return false;
+    }
+    fill(VoxelType(first));
+    return true;
+}
+
+// Uniform: [0, type]. Otherwise [1] followed by (type, uint16 length) runs in index order.
+void VoxelStorage::writeRLE(std::vector<uint8_t>& out) const {
+    if (!data) {
+        out.push_back(0);
+        out.push_back(uniformType);
+        return;
+    }
+    out.push_back(1);
+    int i = 0;
+    while (i < SECTION_VOLUME) {
+        uint8_t type = data[i];
+        int run = 1;
+        while (i + run < SECTION_VOLUME && data[i + run] == type) run++;
+        out.push_back(type);
+        out.push_back(uint8_t(run & 0xff));
+        out.push_back(uint8_t(run >> 8));
+        i += run;
+    }
+}
+
+bool VoxelStorage::readRLE(const uint8_t*& cursor, const uint8_t* end) {
+    if (end - cursor < 2) return false;
+    if (cursor[0] == 0) {
+        if (cursor[1] >= VOXEL_TYPE_COUNT) return false;
+        fill(VoxelType(cursor[1]));
+        cursor += 2;
+        return true;
+    }
+    if (cursor[0] != 1) return false;
+
+    Buffer decoded(acquireBuffer());
+    const uint8_t* p = cursor + 1;
+    int i = 0;
+    while (i < SECTION_VOLUME) {
+        if (end - p < 3) return false;
+        uint8_t type = p[0];
+        int run = p[1] | (p[2] << 8);
+        if (type >= VOXEL_TYPE_COUNT || run == 0 || i + run > SECTION_VOLUME) return false;
+        std::memset(decoded.get() + i, type, run);
+        i += run;
+        p += 3;
+    }
+    data = std::move(decoded);
+    cursor = p;
+    compact();
+    return true;
+}
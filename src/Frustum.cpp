@@ -42,6 +42,44 @@ void Frustum::update(const glm::mat4& viewProj) {
     */
 }
 
+Frustum::Result Frustum::classifyBox(const glm::vec3& min, const glm::vec3& max, unsigned& planeMask, int& planeHint) const {
+    // Frames are coherent, whatever rejected the box last time probably still does
+    if (planeMask & (1u << planeHint)) {
+        const glm::vec4& plane = planes[planeHint];
+        const glm::vec3 positiveVertex = {
+            plane.x > 0 ? max.x : min.x,
+            plane.y > 0 ? max.y : min.y,
+            plane.z > 0 ? max.z : min.z
+        };
+        if (glm::dot(positiveVertex, glm::vec3(plane)) + plane.w < 0) {
+            return Outside;
+        }
+    }
+
+    for (int i = 0; i < Plane::Count; i++) {
+        if (!(planeMask & (1u << i))) continue;
+        const glm::vec4& plane = planes[i];
+        const glm::vec3 positiveVertex = {
+            plane.x > 0 ? max.x : min.x,
+            plane.y > 0 ? max.y : min.y,
+            plane.z > 0 ? max.z : min.z
+        };
+        if (glm::dot(positiveVertex, glm::vec3(plane)) + plane.w < 0) {
+            planeHint = i;
+            return Outside;
+        }
+        const glm::vec3 negativeVertex = {
+            plane.x > 0 ? min.x : max.x,
+            plane.y > 0 ? min.y : max.y,
+            plane.z > 0 ? min.z : max.z
+        };
+        if (glm::dot(negativeVertex, glm::vec3(plane)) + plane.w >= 0) {
+            planeMask &= ~(1u << i);
+        }
+    }
+    return planeMask == 0 ? Inside : Intersecting;
+}
+
 bool Frustum::isBoxVisible(const glm::vec3& min, const glm::vec3& max) const {
     for (int i = 0; i < Plane::Count; i++) {
         const glm::vec3 positiveVertex = {
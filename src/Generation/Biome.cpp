@@ -1,16 +1,27 @@
 #include "Generation/Biomes.h"
-#include "Generation/Noise.h"
+#include "Generation/ColumnCache.h"
 #include "Common.h"
 
-Biome selectBiome(int worldX, int worldZ, int seed) {
-    static Biome biomes[] = {
-        {"Plains", GRASS, DIRT, STONE, 20.0f, 4.0f},
-        {"Mountains", SNOW, GRASS, STONE, 32.0f, 18.0f},
-        {"Desert", SAND, SAND, STONE, 18.0f, 2.0f},
-        {"Forest", GRASS, DIRT, STONE, 22.0f, 5.0f}
-    };
-    const int biomeCount = sizeof(biomes) / sizeof(Biome);
-    float biomeNoise = perlinNoise(worldX * 0.001f, worldZ * 0.001f, seed);
-    int biomeIndex = int((biomeNoise + 1.0f) * 0.5f * biomeCount) % biomeCount;
-    return biomes[biomeIndex];
-}
\ No newline at end of file
+// Built in biomes, replaced by the registry file at startup (see Engine/Registry.h)
+static std::vector<Biome> biomes = {
+    {"Plains", GRASS, DIRT, STONE, 20.0f, 4.0f, false, true},
+    {"Mountains", SNOW, GRASS, STONE, 32.0f, 18.0f, true, true},
+    {"Desert", SAND, SAND, STONE, 18.0f, 2.0f, false, false},
+    {"Forest", GRASS, DIRT, STONE, 22.0f, 5.0f, true, true}
+};
+
+const Biome& getBiome(int index) {
+    return biomes[index];
+}
+
+int getBiomeCount() {
+    return int(biomes.size());
+}
+
+void setBiomes(std::vector<Biome> list) {
+    biomes = std::move(list);
+}
+
+const Biome& selectBiome(int worldX, int worldZ) {
+    return getBiome(ColumnCache::get().getColumn(worldX, worldZ).biome);
+}
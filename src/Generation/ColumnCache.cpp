@@ -0,0 +1,141 @@
+#include "Generation/ColumnCache.h"
+#include "Generation/Biomes.h"
+#include "Generation/Noise.h"
+
+ColumnCache& ColumnCache::get() {
+    static ColumnCache cache;
+    return cache;
+}
+
+void ColumnCache::fillRegion(Region& region) {
+    static thread_local float biomeNoiseMap[COLUMN_REGION_SIZE * COLUMN_REGION_SIZE];
+    static thread_local float heightNoiseMap[COLUMN_REGION_SIZE * COLUMN_REGION_SIZE];
+    static thread_local float treeNoiseMap[COLUMN_REGION_SIZE * COLUMN_REGION_SIZE];
+
+    int originX = region.coord.x * COLUMN_REGION_SIZE;
+    int originZ = region.coord.z * COLUMN_REGION_SIZE;
+    int seed = int(region.seed);
+    fractalNoiseBatch(NOISE_VALUE, originX, originZ, COLUMN_REGION_SIZE, COLUMN_REGION_SIZE, 0.001f, seed, biomeNoiseMap);
+    fractalNoiseBatch(TERRAIN_NOISE, originX, originZ, COLUMN_REGION_SIZE, COLUMN_REGION_SIZE, 0.01f, seed, heightNoiseMap);
+    fractalNoiseBatch(TERRAIN_NOISE, originX, originZ, COLUMN_REGION_SIZE, COLUMN_REGION_SIZE, 0.1f, seed, treeNoiseMap);
+
+    const int biomeCount = getBiomeCount();
+    for (int z = 0; z < COLUMN_REGION_SIZE; z++) {
+        for (int x = 0; x < COLUMN_REGION_SIZE; x++) {
+            int i = z * COLUMN_REGION_SIZE + x;
+            // The noise overshoots [-1, 1] a little (negative coordinates most
+            // of all), wrap so the index always lands in the biome list
+            int biomeIndex = int((biomeNoiseMap[i] + 1.0f) * 0.5f * biomeCount) % biomeCount;
+            if (biomeIndex < 0) biomeIndex += biomeCount;
+            const Biome& biome = getBiome(biomeIndex);
+
+            int height = int(biome.baseHeight + biome.heightVariation * heightNoiseMap[i]);
+            // Clamp height to valid range
+            height = std::max(1, std::min(CHUNK_HEIGHT - 1, height));
+
+            ColumnInfo& column = region.columns[z][x];
+            column.biome = uint8_t(biomeIndex);
+            column.height = uint8_t(height);
+            column.tree = treeNoiseMap[i] > 0.6f;
+        }
+    }
+}
+
+const ColumnCache::Region* ColumnCache::findRegion(ChunkCoord regionCoord) {
+    auto it = lookup.find(regionCoord);
+    if (it == lookup.end()) return nullptr;
+    RegionList::iterator region = it->second;
+    regions.splice(regions.begin(), regions, region);
+    return &*region;
+}
+
+// Regions are never freed while the caller holds the lock, so the reference
+// stays valid until `lock` is released
+const ColumnCache::Region& ColumnCache::acquireRegion(std::unique_lock<std::mutex>& lock, ChunkCoord regionCoord) {
+    if (cacheSeed != GLOBAL_SEED) {
+        regions.clear();
+        lookup.clear();
+        cacheSeed = GLOBAL_SEED;
+    }
+    if (const Region* region = findRegion(regionCoord)) return *region;
+
+    unsigned int seed = cacheSeed;
+    lock.unlock();
+    RegionList fresh(1);
+    fresh.front().coord = regionCoord;
+    fresh.front().seed = seed;
+    fillRegion(fresh.front());
+    lock.lock();
+
+    // Another thread may have filled it while we were unlocked
+    if (const Region* existing = findRegion(regionCoord)) return *existing;
+
+    regions.splice(regions.begin(), fresh);
+    lookup[regionCoord] = regions.begin();
+    while (regions.size() > maxRegions) {
+        lookup.erase(regions.back().coord);
+        regions.pop_back();
+    }
+    return regions.front();
+}
+
+// The border can reach into up to three regions besides the chunk's own
+void ColumnCache::getChunkColumns(ChunkCoord coord, ChunkColumns& out) {
+    int minX = coord.x * CHUNK_SIZE - COLUMN_BORDER;
+    int minZ = coord.z * CHUNK_SIZE - COLUMN_BORDER;
+    int maxX = minX + ChunkColumns::SIZE - 1;
+    int maxZ = minZ + ChunkColumns::SIZE - 1;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (int regionZ = floorDiv(minZ, COLUMN_REGION_SIZE); regionZ <= floorDiv(maxZ, COLUMN_REGION_SIZE); regionZ++) {
+        for (int regionX = floorDiv(minX, COLUMN_REGION_SIZE); regionX <= floorDiv(maxX, COLUMN_REGION_SIZE); regionX++) {
+            const Region& region = acquireRegion(lock, ChunkCoord(regionX, regionZ));
+            int originX = regionX * COLUMN_REGION_SIZE;
+            int originZ = regionZ * COLUMN_REGION_SIZE;
+            int x0 = std::max(minX, originX), x1 = std::min(maxX, originX + COLUMN_REGION_SIZE - 1);
+            int z0 = std::max(minZ, originZ), z1 = std::min(maxZ, originZ + COLUMN_REGION_SIZE - 1);
+            for (int z = z0; z <= z1; z++)
+                for (int x = x0; x <= x1; x++)
+                    out.columns[z - minZ][x - minX] = region.columns[z - originZ][x - originX];
+        }
+    }
+}
+
+ColumnInfo ColumnCache::getColumn(int worldX, int worldZ) {
+    ChunkCoord regionCoord(floorDiv(worldX, COLUMN_REGION_SIZE), floorDiv(worldZ, COLUMN_REGION_SIZE));
+    std::unique_lock<std::mutex> lock(mutex);
+    const Region& region = acquireRegion(lock, regionCoord);
+    return region.columns[worldZ - regionCoord.z * COLUMN_REGION_SIZE][worldX - regionCoord.x * COLUMN_REGION_SIZE];
+}
+
+void ColumnCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    regions.clear();
+    lookup.clear();
+}
+
+void ColumnCache::setMaxRegions(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxRegions = count;
+    while (regions.size() > maxRegions) {
+        lookup.erase(regions.back().coord);
+        regions.pop_back();
+    }
+}
+
+size_t ColumnCache::regionsForDistance(int chunkDistance) {
+    // Any alignment of the square can straddle one more region per axis
+    int span = (2 * chunkDistance + 1) * CHUNK_SIZE + 2 * COLUMN_BORDER;
+    size_t side = size_t((span + COLUMN_REGION_SIZE - 1) / COLUMN_REGION_SIZE + 1);
+    return side * side;
+}
+
+size_t ColumnCache::getRegionCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return regions.size();
+}
+
+size_t ColumnCache::getMemoryUsage() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return regions.size() * sizeof(Region);
+}
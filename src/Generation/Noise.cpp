@@ -1,6 +1,26 @@
 #include "Generation/Noise.h"
 #include "Common.h"
 #include <cmath>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Octave constants, frequency 2^i and amplitude persistence^i with persistence 0.5
+constexpr int NOISE_OCTAVES = 4;
+constexpr float octaveFrequency(int i) { return i == 0 ? 1.0f : 2.0f * octaveFrequency(i - 1); }
+constexpr float octaveAmplitude(int i) { return i == 0 ? 1.0f : 0.5f * octaveAmplitude(i - 1); }
+constexpr float OCTAVE_FREQUENCIES[NOISE_OCTAVES] = {
+    octaveFrequency(0), octaveFrequency(1), octaveFrequency(2), octaveFrequency(3)
+};
+constexpr float OCTAVE_AMPLITUDES[NOISE_OCTAVES] = {
+    octaveAmplitude(0), octaveAmplitude(1), octaveAmplitude(2), octaveAmplitude(3)
+};
 
 float noise(int x, int z, int seed) {
     int n = x + z * 57 + seed * 131;
@@ -9,9 +29,9 @@ float noise(int x, int z, int seed) {
 }
 
 float smoothNoise(float x, float z, int seed) {
-    float corners = (noise(x-1, z-1, GLOBAL_SEED) + noise(x+1, z-1, GLOBAL_SEED) + noise(x-1, z+1, GLOBAL_SEED) + noise(x+1, z+1, GLOBAL_SEED)) / 16.0f;
-    float sides = (noise(x-1, z, GLOBAL_SEED) + noise(x+1, z, GLOBAL_SEED) + noise(x, z-1, GLOBAL_SEED) + noise(x, z+1, GLOBAL_SEED)) / 8.0f;
-    float center = noise(x, z, GLOBAL_SEED) / 4.0f;
+    float corners = (noise(x-1, z-1, seed) + noise(x+1, z-1, seed) + noise(x-1, z+1, seed) + noise(x+1, z+1, seed)) / 16.0f;
+    float sides = (noise(x-1, z, seed) + noise(x+1, z, seed) + noise(x, z-1, seed) + noise(x, z+1, seed)) / 8.0f;
+    float center = noise(x, z, seed) / 4.0f;
     return corners + sides + center;
 }
 
@@ -21,10 +41,10 @@ float interpolatedNoise(float x, float z, int seed) {
     int intZ = (int)z;
     float fracZ = z - intZ;
     
-    float v1 = smoothNoise(intX, intZ, GLOBAL_SEED);
-    float v2 = smoothNoise(intX + 1, intZ, GLOBAL_SEED);
-    float v3 = smoothNoise(intX, intZ + 1, GLOBAL_SEED);
-    float v4 = smoothNoise(intX + 1, intZ + 1, GLOBAL_SEED);
+    float v1 = smoothNoise(intX, intZ, seed);
+    float v2 = smoothNoise(intX + 1, intZ, seed);
+    float v3 = smoothNoise(intX, intZ + 1, seed);
+    float v4 = smoothNoise(intX + 1, intZ + 1, seed);
     
     float i1 = v1 * (1 - fracX) + v2 * fracX;
     float i2 = v3 * (1 - fracX) + v4 * fracX;
@@ -34,14 +54,207 @@ float interpolatedNoise(float x, float z, int seed) {
 
 float perlinNoise(float x, float z, int seed) {
     float total = 0;
-    float persistence = 0.5f;
-    int octaves = 4;
     
-    for (int i = 0; i < octaves; i++) {
-        float frequency = pow(2, i);
-        float amplitude = pow(persistence, i);
-        total += interpolatedNoise(x * frequency, z * frequency, GLOBAL_SEED) * amplitude;
+    for (int i = 0; i < NOISE_OCTAVES; i++) {
+        total += interpolatedNoise(x * OCTAVE_FREQUENCIES[i], z * OCTAVE_FREQUENCIES[i], seed) * OCTAVE_AMPLITUDES[i];
     }
     
     return total;
-}
\ No newline at end of file
+}
+
+// Hashes a lattice point to one of 8 gradient directions
+static int gradientIndex(int x, int z, int seed) {
+    unsigned int h = unsigned(x) * 374761393u + unsigned(z) * 668265263u + unsigned(seed) * 2246822519u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return int((h ^ (h >> 16)) & 7u);
+}
+
+static float gradientDot(int x, int z, int seed, float dx, float dz) {
+    static const float gradients[8][2] = {
+        {1, 1}, {-1, 1}, {1, -1}, {-1, -1},
+        {1, 0}, {-1, 0}, {0, 1}, {0, -1}
+    };
+    const float* g = gradients[gradientIndex(x, z, seed)];
+    return g[0] * dx + g[1] * dz;
+}
+
+float simplexNoise(float x, float z, int seed) {
+    const float F2 = 0.36602540378f; // (sqrt(3) - 1) / 2
+    const float G2 = 0.21132486540f; // (3 - sqrt(3)) / 6
+
+    // Skew into the simplex grid and find which of the two triangles we're in
+    float s = (x + z) * F2;
+    int i = (int)std::floor(x + s);
+    int j = (int)std::floor(z + s);
+    float t = (i + j) * G2;
+    float x0 = x - (i - t);
+    float z0 = z - (j - t);
+    int i1 = x0 > z0 ? 1 : 0;
+    int j1 = 1 - i1;
+
+    float x1 = x0 - i1 + G2;
+    float z1 = z0 - j1 + G2;
+    float x2 = x0 - 1.0f + 2.0f * G2;
+    float z2 = z0 - 1.0f + 2.0f * G2;
+
+    float total = 0.0f;
+    float t0 = 0.5f - x0 * x0 - z0 * z0;
+    if (t0 > 0) { t0 *= t0; total += t0 * t0 * gradientDot(i, j, seed, x0, z0); }
+    float t1 = 0.5f - x1 * x1 - z1 * z1;
+    if (t1 > 0) { t1 *= t1; total += t1 * t1 * gradientDot(i + i1, j + j1, seed, x1, z1); }
+    float t2 = 0.5f - x2 * x2 - z2 * z2;
+    if (t2 > 0) { t2 *= t2; total += t2 * t2 * gradientDot(i + 1, j + 1, seed, x2, z2); }
+
+    // Scales the result to roughly [-1, 1]
+    return 70.0f * total;
+}
+
+float fractalSimplexNoise(float x, float z, int seed) {
+    float total = 0;
+    for (int i = 0; i < NOISE_OCTAVES; i++) {
+        total += simplexNoise(x * OCTAVE_FREQUENCIES[i], z * OCTAVE_FREQUENCIES[i], seed) * OCTAVE_AMPLITUDES[i];
+    }
+    return total;
+}
+
+// Just enough of a float vector to do the bilinear blend, one type per ISA
+#if defined(__AVX2__)
+struct FloatLanes {
+    static constexpr int WIDTH = 8;
+    __m256 v;
+    static FloatLanes load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static FloatLanes set(float f) { return {_mm256_set1_ps(f)}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    friend FloatLanes operator+(FloatLanes a, FloatLanes b) { return {_mm256_add_ps(a.v, b.v)}; }
+    friend FloatLanes operator-(FloatLanes a, FloatLanes b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    friend FloatLanes operator*(FloatLanes a, FloatLanes b) { return {_mm256_mul_ps(a.v, b.v)}; }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+struct FloatLanes {
+    static constexpr int WIDTH = 4;
+    __m128 v;
+    static FloatLanes load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static FloatLanes set(float f) { return {_mm_set1_ps(f)}; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    friend FloatLanes operator+(FloatLanes a, FloatLanes b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend FloatLanes operator-(FloatLanes a, FloatLanes b) { return {_mm_sub_ps(a.v, b.v)}; }
+    friend FloatLanes operator*(FloatLanes a, FloatLanes b) { return {_mm_mul_ps(a.v, b.v)}; }
+};
+#elif defined(__ARM_NEON)
+struct FloatLanes {
+    static constexpr int WIDTH = 4;
+    float32x4_t v;
+    static FloatLanes load(const float* p) { return {vld1q_f32(p)}; }
+    static FloatLanes set(float f) { return {vdupq_n_f32(f)}; }
+    void store(float* p) const { vst1q_f32(p, v); }
+    friend FloatLanes operator+(FloatLanes a, FloatLanes b) { return {vaddq_f32(a.v, b.v)}; }
+    friend FloatLanes operator-(FloatLanes a, FloatLanes b) { return {vsubq_f32(a.v, b.v)}; }
+    friend FloatLanes operator*(FloatLanes a, FloatLanes b) { return {vmulq_f32(a.v, b.v)}; }
+};
+#else
+struct FloatLanes {
+    static constexpr int WIDTH = 1;
+    float v;
+    static FloatLanes load(const float* p) { return {*p}; }
+    static FloatLanes set(float f) { return {f}; }
+    void store(float* p) const { *p = v; }
+    friend FloatLanes operator+(FloatLanes a, FloatLanes b) { return {a.v + b.v}; }
+    friend FloatLanes operator-(FloatLanes a, FloatLanes b) { return {a.v - b.v}; }
+    friend FloatLanes operator*(FloatLanes a, FloatLanes b) { return {a.v * b.v}; }
+};
+#endif
+
+// Per-thread scratch so batches don't allocate once warmed up
+struct NoiseScratch {
+    std::vector<int> cellX, cellZ;
+    std::vector<float> fracX, fracZ;
+    std::vector<float> lattice;
+    // Lattice values gathered per sample, laid out so a row can be loaded into lanes
+    std::vector<float> v1, v2, v3, v4;
+};
+
+// One octave of interpolatedNoise for the whole grid, accumulated into `out`
+static void valueOctaveBatch(NoiseScratch& scratch, int originX, int originZ, int width, int depth,
+                             float scale, float frequency, float amplitude, int seed, float* out) {
+    // Same float steps as perlinNoise(worldX * scale, ...) so the results match exactly
+    scratch.cellX.resize(width);
+    scratch.fracX.resize(width);
+    for (int x = 0; x < width; x++) {
+        float sampleX = float(originX + x) * scale * frequency;
+        scratch.cellX[x] = (int)sampleX;
+        scratch.fracX[x] = sampleX - scratch.cellX[x];
+    }
+    scratch.cellZ.resize(depth);
+    scratch.fracZ.resize(depth);
+    for (int z = 0; z < depth; z++) {
+        float sampleZ = float(originZ + z) * scale * frequency;
+        scratch.cellZ[z] = (int)sampleZ;
+        scratch.fracZ[z] = sampleZ - scratch.cellZ[z];
+    }
+
+    // Truncation is monotonic, so the cells span first..last (+1 for the far corner)
+    int minCellX = scratch.cellX[0];
+    int minCellZ = scratch.cellZ[0];
+    int latticeWidth = scratch.cellX[width - 1] - minCellX + 2;
+    int latticeDepth = scratch.cellZ[depth - 1] - minCellZ + 2;
+    scratch.lattice.resize(size_t(latticeWidth) * latticeDepth);
+    for (int lz = 0; lz < latticeDepth; lz++)
+        for (int lx = 0; lx < latticeWidth; lx++)
+            scratch.lattice[lz * latticeWidth + lx] = smoothNoise(minCellX + lx, minCellZ + lz, seed);
+
+    scratch.v1.resize(width);
+    scratch.v2.resize(width);
+    scratch.v3.resize(width);
+    scratch.v4.resize(width);
+    const FloatLanes one = FloatLanes::set(1.0f);
+    const FloatLanes amplitudeLanes = FloatLanes::set(amplitude);
+
+    for (int z = 0; z < depth; z++) {
+        const float* row0 = &scratch.lattice[(scratch.cellZ[z] - minCellZ) * latticeWidth];
+        const float* row1 = row0 + latticeWidth;
+        for (int x = 0; x < width; x++) {
+            int lx = scratch.cellX[x] - minCellX;
+            scratch.v1[x] = row0[lx];
+            scratch.v2[x] = row0[lx + 1];
+            scratch.v3[x] = row1[lx];
+            scratch.v4[x] = row1[lx + 1];
+        }
+
+        float fracZ = scratch.fracZ[z];
+        FloatLanes fz = FloatLanes::set(fracZ);
+        float* outRow = out + z * width;
+        int x = 0;
+        for (; x + FloatLanes::WIDTH <= width; x += FloatLanes::WIDTH) {
+            FloatLanes fx = FloatLanes::load(&scratch.fracX[x]);
+            FloatLanes i1 = FloatLanes::load(&scratch.v1[x]) * (one - fx) + FloatLanes::load(&scratch.v2[x]) * fx;
+            FloatLanes i2 = FloatLanes::load(&scratch.v3[x]) * (one - fx) + FloatLanes::load(&scratch.v4[x]) * fx;
+            FloatLanes value = i1 * (one - fz) + i2 * fz;
+            (FloatLanes::load(outRow + x) + value * amplitudeLanes).store(outRow + x);
+        }
+        for (; x < width; x++) {
+            float fx = scratch.fracX[x];
+            float i1 = scratch.v1[x] * (1 - fx) + scratch.v2[x] * fx;
+            float i2 = scratch.v3[x] * (1 - fx) + scratch.v4[x] * fx;
+            outRow[x] += (i1 * (1 - fracZ) + i2 * fracZ) * amplitude;
+        }
+    }
+}
+
+void fractalNoiseBatch(NoiseType type, int originX, int originZ, int width, int depth,
+                       float scale, int seed, float* out) {
+    if (width <= 0 || depth <= 0) return;
+
+    if (type == NOISE_SIMPLEX) {
+        for (int z = 0; z < depth; z++)
+            for (int x = 0; x < width; x++)
+                out[z * width + x] = fractalSimplexNoise(float(originX + x) * scale, float(originZ + z) * scale, seed);
+        return;
+    }
+
+    static thread_local NoiseScratch scratch;
+    for (int i = 0; i < width * depth; i++) out[i] = 0.0f;
+    for (int i = 0; i < NOISE_OCTAVES; i++) {
+        valueOctaveBatch(scratch, originX, originZ, width, depth, scale,
+                         OCTAVE_FREQUENCIES[i], OCTAVE_AMPLITUDES[i], seed, out);
+    }
+}
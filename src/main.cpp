@@ -2,8 +2,13 @@
 #include "Engine/Camera.h"
 #include "Engine/Chunk.h"
 #include "Engine/InfiniteWorld.h"
+#include "Engine/Profiler.h"
+#include "Engine/Registry.h"
+#include "Engine/Replay.h"
+#include "Engine/TextureArray.h"
 #include "Frustum.h"
 #include "Generation/Biomes.h"
+#include "Generation/ColumnCache.h"
 #include "Generation/Noise.h"
 
 #include <GL/glew.h>
@@ -15,6 +20,7 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <random>
+#include <thread>
 unsigned int GLOBAL_SEED = 0;
 
 #include <iostream>
@@ -24,7 +30,6 @@ unsigned int GLOBAL_SEED = 0;
     * - Optimize chunk rendering and loading.
     * - Implement a more sophisticated noise generation algorithm for terrain.
     * - Add lighting effects and shadows.
-    * - Add Atlas texture support for voxel textures.
 */
 
 const unsigned int SCR_WIDTH = 1280;
@@ -75,17 +80,95 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
-void renderUI(const Camera& camera, float fps) {
+void renderProfilerUI(InfiniteWorld& world) {
+    Profiler& profiler = Profiler::get();
+    const FrameCounters& counters = profiler.getLastCounters();
+
+    if (ImGui::CollapsingHeader("Profiler", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Text("Frame: p50 %.2f ms  p99 %.2f ms", profiler.getFramePercentile(50.0f), profiler.getFramePercentile(99.0f));
+        ImGui::PlotLines("##frametimes", profiler.getFrameHistory(), Profiler::HISTORY_SIZE,
+                         profiler.getHistoryOffset(), "frame ms", 0.0f, 33.3f, ImVec2(240, 60));
+        ImGui::Text("GPU: %.2f ms", profiler.getGpuTime());
+        for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+            ProfileScope scope = static_cast<ProfileScope>(i);
+            ImGui::Text("%-20s %7.2f ms (%d)", Profiler::getScopeName(scope), profiler.getScopeTime(scope), profiler.getScopeCount(scope));
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Draws: %d  Triangles: %ld", counters.drawCalls, counters.triangles);
+        ImGui::Text("Chunks: %d visible, %d culled", counters.visibleChunks, counters.culledChunks);
+        ImGui::Text("Sections: %d visible, %d culled, %d occluded", counters.visibleSections,
+                    counters.culledSections, counters.occludedSections);
+        bool occlusionCulling = world.renderer.isOcclusionCullingEnabled();
+        if (ImGui::Checkbox("Occlusion culling", &occlusionCulling)) {
+            world.renderer.setOcclusionCulling(occlusionCulling);
+        }
+        ImGui::Checkbox("Level of detail", &world.levelOfDetail);
+        ImGui::Text("Streamed: %d chunks, %d meshes", counters.chunksLoaded, counters.meshesUploaded);
+        ImGui::Text("Uploaded: %.1f KiB", counters.bytesUploaded / 1024.0f);
+        const WorldMemoryStats& memory = world.getMemoryStats();
+        const float MiB = 1024.0f * 1024.0f;
+        ImGui::Text("Resident: %.1f MiB of %.0f MiB budget", memory.getTotal() / MiB,
+                    world.settings.memoryBudget / MiB);
+        ImGui::Text("  voxels %.1f  CPU meshes %.1f  GPU meshes %.1f (of %.1f) MiB", memory.voxelBytes / MiB,
+                    memory.cpuMeshBytes / MiB, memory.gpuMeshBytes / MiB, memory.gpuMeshCapacityBytes / MiB);
+        ImGui::Text("  retained %d chunks, %.1f MiB", memory.retainedChunks, memory.retainedBytes / MiB);
+        ImGui::Text("Evicted %ld chunks, restored %ld", memory.evictedChunks, memory.restoredChunks);
+        ImGui::Text("Column cache: %zu regions, %.1f MiB", ColumnCache::get().getRegionCount(),
+                    ColumnCache::get().getMemoryUsage() / (1024.0f * 1024.0f));
+
+        if (profiler.isCapturing()) {
+            ImGui::Text("Capturing trace...");
+        } else if (ImGui::Button("Capture trace (120 frames)")) {
+            profiler.captureTrace(120, "voxel_trace.json");
+        }
+    }
+}
+
+void renderSettingsUI(InfiniteWorld& world) {
+    WorldSettings& settings = world.settings;
+    if (!ImGui::CollapsingHeader("World settings")) return;
+
+    ImGui::SliderInt("Render distance", &settings.renderDistance, 2, 32);
+    ImGui::SliderInt("Unload margin", &settings.unloadMargin, 0, 8);
+    int hardwareThreads = int(std::max(std::thread::hardware_concurrency(), 2u));
+    ImGui::SliderInt("Worker threads (0 = auto)", &settings.workerThreads, 0, hardwareThreads);
+    ImGui::SliderInt("Mesh uploads / frame", &settings.maxMeshUploadsPerFrame, 1, 128);
+    int uploadKiB = int(settings.maxMeshUploadBytesPerFrame / 1024);
+    if (ImGui::SliderInt("Upload KiB / frame", &uploadKiB, 64, 16384)) {
+        settings.maxMeshUploadBytesPerFrame = size_t(uploadKiB) * 1024;
+    }
+    int budgetMiB = int(settings.memoryBudget / (1024 * 1024));
+    if (ImGui::SliderInt("Memory budget MiB (0 = none)", &budgetMiB, 0, 8192)) {
+        settings.memoryBudget = size_t(budgetMiB) * 1024 * 1024;
+    }
+    int retainedMiB = int(settings.retainedChunkBudget / (1024 * 1024));
+    if (ImGui::SliderInt("Retained chunks MiB", &retainedMiB, 0, 1024)) {
+        settings.retainedChunkBudget = size_t(retainedMiB) * 1024 * 1024;
+    }
+
+    ImGui::Checkbox("Adaptive quality", &settings.adaptiveQuality);
+    ImGui::SliderFloat("Target frame ms", &settings.targetFrameMs, 4.0f, 50.0f, "%.1f");
+    ImGui::SliderInt("Min render distance", &settings.minRenderDistance, 1, 16);
+    ImGui::Text("Active: distance %d, LOD rings at %.0f%%", world.getRenderDistance(),
+                world.getLodDistanceScale() * 100.0f);
+}
+
+void renderUI(const Camera& camera, InfiniteWorld& world, float fps) {
     ImGui::Begin("Debug Info", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
     ImGui::Text("FPS: %.1f", fps);
     ImGui::Text("Position: (%.2f, %.2f, %.2f)", camera.position.x, camera.position.y, camera.position.z);
     ImGui::Text("Chunk: (%d, %d)", camera.getCurrentChunkCoord().x, camera.getCurrentChunkCoord().z);
+    ImGui::Text("Chunks: %d loaded, %d loading, %d queued", world.getLoadedChunkCount(),
+                world.getPendingChunkCount(), world.getRequestedChunkCount());
 
     int playerX = static_cast<int>(camera.position.x);
     int playerZ = static_cast<int>(camera.position.z);
-    Biome biome = selectBiome(playerX, playerZ, GLOBAL_SEED);
+    const Biome& biome = selectBiome(playerX, playerZ);
     ImGui::Text("Biome: %s", biome.name.c_str());
 
+    renderProfilerUI(world);
+    renderSettingsUI(world);
     ImGui::End();
 }
 
@@ -126,68 +209,52 @@ GLuint compileShader(const char* vertexSrc, const char* fragmentSrc) {
     return shaderProgram;
 }
 
-bool pickVoxel(const Camera& camera, InfiniteWorld& world, glm::ivec3& outBlock, glm::ivec3& outNormal, float maxDistance = 6.0f){
-    glm::vec3 origin = camera.position;
-    glm::vec3 dir = glm::normalize(camera.front);
-    glm::ivec3 lastBlock(-9999);
-    for (float t = 0.0f; t < maxDistance; t += 0.05f) {
-        glm::vec3 pos = origin + dir * t;
-        glm::ivec3 block = glm::floor(pos);
-        if (block != lastBlock) {
-            if (world.isVoxelSolidAt(block.x, block.y, block.z)) {
-                outBlock = block;
-                // Approximate normal
-                glm::vec3 prev = origin + dir * (t - 0.05f);
-                glm::ivec3 prevBlock = glm::floor(prev);
-                outNormal = prevBlock - block;
-                // Clamp normal to -1/0/1
-                outNormal.x = (outNormal.x > 0) ? 1 : (outNormal.x < 0 ? -1 : 0);
-                outNormal.y = (outNormal.y > 0) ? 1 : (outNormal.y < 0 ? -1 : 0);
-                outNormal.z = (outNormal.z > 0) ? 1 : (outNormal.z < 0 ? -1 : 0);
-                return true;
-            }
-            lastBlock = block;
-        }
-    }
-    return false;
-}
-
 void processInteraction(GLFWwindow* window, const Camera& camera, InfiniteWorld& world) {
     static bool leftMousePressedLast = false;
     static bool rightMousePressedLast = false;
+    static bool middleMousePressedLast = false;
 
     bool leftMousePressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
     bool rightMousePressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+    bool middleMousePressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS;
 
-    glm::ivec3 block, normal;
-    if (pickVoxel(camera, world, block, normal)) {
+    RaycastHit hit;
+    if (world.raycast(camera.position, camera.front, 6.0f, hit)) {
         // Remove block on left click (single press)
         if (leftMousePressed && !leftMousePressedLast) {
-            world.setVoxel(block.x, block.y, block.z, AIR);
+            world.setVoxel(hit.voxel.x, hit.voxel.y, hit.voxel.z, AIR);
         }
-        // Place block on right click (single press)
-        if (rightMousePressed && !rightMousePressedLast) {
-            glm::ivec3 placePos = block + normal;
+        // Place a log on right click, a lamp on middle click (single press)
+        bool placeLog = rightMousePressed && !rightMousePressedLast;
+        bool placeLamp = middleMousePressed && !middleMousePressedLast;
+        if (placeLog || placeLamp) {
+            glm::ivec3 placePos = hit.voxel + hit.normal;
             if (world.getVoxelTypeAt(placePos.x, placePos.y, placePos.z) == AIR) {
-                world.setVoxel(placePos.x, placePos.y, placePos.z, LOG); // Or any type you want
+                world.setVoxel(placePos.x, placePos.y, placePos.z, placeLamp ? LAMP : LOG);
             }
         }
     }
     leftMousePressedLast = leftMousePressed;
     rightMousePressedLast = rightMousePressed;
+    middleMousePressedLast = middleMousePressed;
 }
 
+// Only waits for the STARTUP_LOAD_RADIUS ring, the rest streams in while playing
 void loadingScreen(GLFWwindow* window, InfiniteWorld& world) {
     ChunkCoord playerChunk = camera.getCurrentChunkCoord();
-    int totalChunks = (2 * RENDER_DISTANCE + 1) * (2 * RENDER_DISTANCE + 1);
-    int loadedChunks = 0;
+    int side = 2 * STARTUP_LOAD_RADIUS + 1;
+    int totalChunks = side * side;
+
+    world.loadChunksAroundPlayer(playerChunk);
+
+    while (!world.isAreaLoaded(playerChunk, STARTUP_LOAD_RADIUS) && !glfwWindowShouldClose(window)) {
+        world.update(camera);
 
-    for (int x = playerChunk.x - RENDER_DISTANCE; x <= playerChunk.x + RENDER_DISTANCE; ++x) {
-    for (int z = playerChunk.z - RENDER_DISTANCE; z <= playerChunk.z + RENDER_DISTANCE; ++z) {
-        world.loadChunk(ChunkCoord(x, z));
-        loadedChunks++;
+        int loaded = 0;
+        for (int x = -STARTUP_LOAD_RADIUS; x <= STARTUP_LOAD_RADIUS; x++)
+            for (int z = -STARTUP_LOAD_RADIUS; z <= STARTUP_LOAD_RADIUS; z++)
+                if (world.getChunk(ChunkCoord(playerChunk.x + x, playerChunk.z + z))) loaded++;
 
-        // Optionally update the loading screen with progress
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -196,34 +263,65 @@ void loadingScreen(GLFWwindow* window, InfiniteWorld& world) {
         ImGui::SetNextWindowSize(ImVec2(200, 60), ImGuiCond_Always);
         ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
         ImGui::Text("Loading world...");
-        ImGui::ProgressBar((float)loadedChunks / totalChunks, ImVec2(180, 20));
+        ImGui::ProgressBar((float)loaded / totalChunks, ImVec2(180, 20));
         ImGui::End();
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         glfwSwapBuffers(window);
         glfwPollEvents();
-        }
     }
 }
 
 const char* vertexShaderSource = R"(
 #version 330 core
-layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
-layout(location = 2) in vec3 aColor;
+// Packed vertex, see packVertex() and packLight() in ChunkMesher.h
+layout(location = 0) in uint aData;
+layout(location = 2) in uint aLight;
+// Per draw, see ChunkRenderer
+layout(location = 1) in vec3 sectionOrigin;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec3 Color;
+// World space, one texture repeat per voxel, see TextureArray.h
+out vec2 TexCoord;
+flat out uint Layer;
+// x sky light, y block light, z ambient occlusion, all 0..1
+out vec3 Light;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+const vec3 normals[6] = vec3[6](
+    vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0),
+    vec3(0.0, 1.0, 0.0), vec3(0.0, -1.0, 0.0),
+    vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0)
+);
+
 void main() {
+    vec3 localPos = vec3(float(aData & 31u), float((aData >> 5) & 31u), float((aData >> 10) & 31u));
+    uint normalIndex = (aData >> 15) & 7u;
+    uint voxelType = (aData >> 18) & 255u;
+    float lodScale = float(1u << ((aData >> 26) & 3u));
+
+    vec3 aPos = sectionOrigin + localPos * lodScale;
+    vec3 aNormal = normals[normalIndex];
+
+    // Top faces full color, bottom darker, sides slightly dim
+    float bakedShade = normalIndex == 2u ? 1.0 : (normalIndex == 3u ? 0.7 : 0.85);
+    vec3 aColor = vec3(bakedShade);
+
+    // Top, side or bottom layer of this voxel type, textures tile across merged quads
+    uint face = normalIndex == 2u ? 0u : (normalIndex == 3u ? 2u : 1u);
+    Layer = voxelType * 3u + face;
+    uint axis = normalIndex >> 1;
+    TexCoord = axis == 0u ? aPos.zy : (axis == 1u ? aPos.xz : aPos.xy);
+
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;
     Color = aColor;
+    Light = vec3(float((aLight >> 4) & 15u) / 15.0, float(aLight & 15u) / 15.0, float((aLight >> 8) & 3u) / 3.0);
     gl_Position = projection * view * model * vec4(aPos, 1.0);
 }
 )";
@@ -233,14 +331,23 @@ const char* fragmentShaderSource = R"(
 in vec3 FragPos;
 in vec3 Normal;
 in vec3 Color;
+in vec2 TexCoord;
+flat in uint Layer;
+in vec3 Light;
 
 out vec4 FragColor;
 
+uniform sampler2DArray voxelTextures;
+
 uniform vec3 lightDir = normalize(vec3(1.0, 2.0, 1.0));
 uniform vec3 viewPos;
 
 void main() {
     vec3 norm = normalize(Normal);
+    vec4 texel = texture(voxelTextures, vec3(TexCoord, float(Layer)));
+    // Cut out the gaps in leaves, the rest of the alpha blends in the translucent pass
+    if (texel.a < 0.1) discard;
+    vec3 albedo = texel.rgb * Color;
 
     // Face shading: brighter top, darker bottom, normal sides
     float faceShade = 1.0;
@@ -251,37 +358,122 @@ void main() {
     else                   // Sides
         faceShade = 0.9;
 
+    // Each light level is 80% of the one above, lamps are warmer than the sky
+    float skyLight = pow(0.8, 15.0 * (1.0 - Light.x));
+    float blockLight = Light.y > 0.0 ? pow(0.8, 15.0 * (1.0 - Light.y)) : 0.0;
+    vec3 lightColor = max(vec3(skyLight), blockLight * vec3(1.0, 0.85, 0.6));
+    float occlusion = 0.5 + 0.5 * Light.z;
+
     // Ambient
     float ambientStrength = 0.35;
-    vec3 ambient = ambientStrength * Color * faceShade;
+    vec3 ambient = ambientStrength * albedo * faceShade * lightColor;
 
-    // Diffuse
+    // Diffuse, only the sun lights faces directly
     float diff = max(dot(norm, -lightDir), 0.0);
-    vec3 diffuse = diff * Color * faceShade;
+    vec3 diffuse = diff * albedo * faceShade * skyLight;
 
     // Specular
     float specularStrength = 0.25;
     vec3 viewDir = normalize(viewPos - FragPos);
     vec3 reflectDir = reflect(lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 16.0);
-    vec3 specular = specularStrength * spec * vec3(1.0);
+    vec3 specular = specularStrength * spec * vec3(1.0) * skyLight;
 
-    vec3 result = ambient + diffuse + specular;
+    vec3 result = (ambient + diffuse + specular) * occlusion;
 
     // Gamma correction
     result = pow(result, vec3(1.0/2.2));
 
-    FragColor = vec4(result, 1.0);
+    FragColor = vec4(result, texel.a);
 }
 )";
 
-int main() {
+// Command line:
+//   --seed N          world seed instead of a random one
+//   --replay PATH     fly a recorded camera path ("standard" for the built in route)
+//                     at a fixed timestep, write per-frame times to --out and quit
+//   --out PATH        replay CSV, replay.csv by default
+//   --max-p99 MS      exit with 1 when the replay's p99 CPU frame time is above MS
+//   --record PATH     save the camera path of a normal session on exit
+//   --textures PATH   voxel texture blob, VOXEL_ASSET_DIR/textures.bin by default
+//   --bake-textures PATH  write the built in textures as a blob and quit
+//   --registry PATH   block and biome definitions, VOXEL_ASSET_DIR/registry.cfg by default
+struct LaunchOptions {
+    bool hasSeed = false;
+    unsigned int seed = 0;
+    std::string replayPath;
+    std::string outPath = "replay.csv";
+    float maxP99 = 0.0f;
+    std::string recordPath;
+    std::string texturePath = std::string(VOXEL_ASSET_DIR) + "/textures.bin";
+    std::string bakeTexturesPath;
+    std::string registryPath = std::string(VOXEL_ASSET_DIR) + "/registry.cfg";
+};
+
+bool parseOptions(int argc, char** argv, LaunchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << "\n";
+            return false;
+        }
+        const char* value = argv[++i];
+        if (option == "--seed") {
+            options.hasSeed = true;
+            options.seed = unsigned(std::strtoul(value, nullptr, 10));
+        } else if (option == "--replay") {
+            options.replayPath = value;
+        } else if (option == "--out") {
+            options.outPath = value;
+        } else if (option == "--max-p99") {
+            options.maxP99 = float(std::atof(value));
+        } else if (option == "--record") {
+            options.recordPath = value;
+        } else if (option == "--textures") {
+            options.texturePath = value;
+        } else if (option == "--bake-textures") {
+            options.bakeTexturesPath = value;
+        } else if (option == "--registry") {
+            options.registryPath = value;
+        } else {
+            std::cerr << "Unknown option " << option << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    LaunchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return -1;
+    }
+
+    // Before anything reads the block tables, texture baking included
+    loadRegistry(options.registryPath);
+
+    if (!options.bakeTexturesPath.empty()) {
+        return TextureAtlasData::bake().save(options.bakeTexturesPath) ? 0 : -1;
+    }
+
+    // Replays fail before a window opens if the path is no good
+    bool replaying = !options.replayPath.empty();
+    CameraPath replayPath;
+    if (replaying) {
+        if (options.replayPath == "standard") {
+            replayPath = CameraPath::standardRoute();
+        } else if (!replayPath.load(options.replayPath)) {
+            return -1;
+        }
+    }
+
     // GLFW init
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW\n";
         return -1;
     }
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // 4.3 for glMultiDrawElementsIndirect
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -306,8 +498,12 @@ int main() {
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
 
-    std::random_device rd;
-    GLOBAL_SEED = rd(); // Use a random seed for world generation
+    if (options.hasSeed) {
+        GLOBAL_SEED = options.seed;
+    } else {
+        std::random_device rd;
+        GLOBAL_SEED = rd(); // Use a random seed for world generation
+    }
 
     // ImGui setup
     IMGUI_CHECKVERSION();
@@ -320,21 +516,56 @@ int main() {
     // Shader
     GLuint shaderProgram = compileShader(vertexShaderSource, fragmentShaderSource);
 
+    // Every voxel texture in one array, bound once for the whole world
+    TextureArray voxelTextures;
+    voxelTextures.init(options.texturePath);
+    glUseProgram(shaderProgram);
+    glUniform1i(glGetUniformLocation(shaderProgram, "voxelTextures"), 0);
+
     // World
     InfiniteWorld world;
+    GpuTimer gpuTimer;
+    // Interactive sessions hold their frame rate, replays measure a fixed workload
+    world.settings.adaptiveQuality = !replaying;
+
+    // Replays always generate (saved edits would change the workload) and
+    // don't wait for vsync, so the frame times are the engine's own
+    ReplayLog replayLog;
+    int replayFrame = 0;
+    if (replaying) {
+        world.persistChunks = false;
+        glfwSwapInterval(0);
+        replayPath.apply(0.0f, camera);
+        if (!replayLog.open(options.outPath)) {
+            return -1;
+        }
+    }
+    CameraPath recordedPath;
+    bool recording = !options.recordPath.empty();
 
     loadingScreen(window, world);
+    float sessionStart = glfwGetTime();
 
     // Main loop
     while (!glfwWindowShouldClose(window)) {
-        processInput(window);
-        processInteraction(window, camera, world);
+        Profiler::get().beginFrame();
+        if (replaying) {
+            if (!replayPath.apply(replayFrame * REPLAY_TIMESTEP, camera)) break;
+            deltaTime = REPLAY_TIMESTEP;
+            if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+                glfwSetWindowShouldClose(window, true);
+        } else {
+            processInput(window);
+            processInteraction(window, camera, world);
+        }
 
         glClearColor(0.53f, 0.81f, 0.92f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Camera/view/projection
-        mat4 projection = glm::perspective(glm::radians(70.0f), (float)SCR_WIDTH / SCR_HEIGHT, 0.1f, 1000.0f);
+        // Camera/view/projection, the far plane just covers the furthest chunk corner drawn
+        float reach = world.maxDrawDistance + CHUNK_SIZE * 1.5f;
+        float farPlane = std::sqrt(reach * reach + float(CHUNK_HEIGHT * CHUNK_HEIGHT));
+        mat4 projection = glm::perspective(glm::radians(70.0f), (float)SCR_WIDTH / SCR_HEIGHT, 0.1f, farPlane);
         mat4 view = camera.getViewMatrix();
         mat4 model = glm::mat4(1.0f);
 
@@ -346,7 +577,12 @@ int main() {
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, &model[0][0]);
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, &view[0][0]);
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
-        world.render(projection * view);
+        // ImGui binds its own textures, so this is the one bind per frame
+        voxelTextures.bind(0);
+        gpuTimer.begin();
+        world.render(projection * view, camera.position);
+        gpuTimer.end();
+        Profiler::get().setGpuTime(gpuTimer.getTime());
 
         // ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -354,7 +590,7 @@ int main() {
         ImGui::NewFrame();
 
         float fps = 1.0f / (deltaTime > 0 ? deltaTime : 1.0f);
-        renderUI(camera, fps);
+        renderUI(camera, world, fps);
 
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -362,6 +598,44 @@ int main() {
         glfwSwapBuffers(window);
         glfwPollEvents();
         glDisable(GL_CULL_FACE);
+        Profiler::get().getCounters().voxelMemory = world.getMemoryStats().voxelBytes;
+        Profiler::get().endFrame();
+        world.adaptQuality(Profiler::get().getLastFrameTime(), world.getMemoryStats().getTotal());
+
+        if (replaying) {
+            const Profiler& profiler = Profiler::get();
+            const FrameCounters& counters = profiler.getLastCounters();
+            ReplayFrame frame;
+            frame.frame = replayFrame;
+            frame.time = replayFrame * REPLAY_TIMESTEP;
+            frame.cpuTime = profiler.getLastFrameTime();
+            frame.gpuTime = profiler.getGpuTime();
+            frame.updateTime = profiler.getScopeTime(PROFILE_WORLD_UPDATE);
+            frame.renderTime = profiler.getScopeTime(PROFILE_RENDER);
+            frame.chunksLoaded = counters.chunksLoaded;
+            frame.meshesUploaded = counters.meshesUploaded;
+            frame.drawCalls = counters.drawCalls;
+            frame.triangles = counters.triangles;
+            replayLog.addFrame(frame);
+            replayFrame++;
+        }
+        if (recording) {
+            recordedPath.addKeyframe(glfwGetTime() - sessionStart, camera);
+        }
+    }
+
+    int exitCode = 0;
+    if (replaying) {
+        replayLog.close();
+        std::cout << "Seed " << GLOBAL_SEED << ", wrote " << options.outPath << "\n";
+        replayLog.printSummary();
+        if (options.maxP99 > 0.0f && replayLog.getCpuPercentile(99.0f) > options.maxP99) {
+            std::cerr << "p99 frame time above the " << options.maxP99 << " ms budget\n";
+            exitCode = 1;
+        }
+    }
+    if (recording) {
+        recordedPath.save(options.recordPath);
     }
 
     // Cleanup
@@ -370,5 +644,5 @@ int main() {
     ImGui::DestroyContext();
     glfwDestroyWindow(window);
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
\ No newline at end of file